@@ -0,0 +1,224 @@
+#include <wadjet/socket_group.hpp>
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <span>
+#include <thread>
+#include <vector>
+
+// Compares flow-hashed reuseport workers against CPU-steered workers pinned to their member's CPU.
+// One sender thread per CPU emulates a multi-queue NIC - loopback packets are processed by the
+// network stack on the sending CPU, much like packets from a NIC queue are processed on the CPU
+// serving its interrupt. Each worker counts the cache misses it incurs, kernel side included where
+// permitted.
+
+namespace {
+
+constexpr size_t flows_per_sender = 16;
+constexpr size_t datagram_size    = 64;
+
+constexpr auto duration = std::chrono::seconds{2};
+
+struct worker_result
+{
+    uint64_t packets      = 0;
+    uint64_t cache_misses = 0;
+    bool     counted      = false;
+};
+
+// Opens a cache miss counter for the calling thread, or returns -1 if counters aren't available.
+int open_cache_miss_counter()
+{
+    ::perf_event_attr attributes;
+    std::memset(&attributes, 0, sizeof(attributes));
+    attributes.size   = sizeof(attributes);
+    attributes.type   = PERF_TYPE_HARDWARE;
+    attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+
+    // Kernel-side misses are where most of the cross-core traffic shows up, but counting them
+    // might not be permitted.
+    for(int exclude_kernel = 0; exclude_kernel < 2; ++exclude_kernel)
+    {
+        attributes.exclude_kernel = exclude_kernel;
+
+        const long counter = ::syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+        if(counter >= 0)
+            return static_cast<int>(counter);
+    }
+
+    return -1;
+}
+
+// Senders aren't group members, so they're pinned directly.
+void pin_thread(int cpu)
+{
+    ::cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    (void)::sched_setaffinity(0, sizeof(cpus), &cpus);
+}
+
+void run_sender(int cpu, wadjet::socket_address destination, const std::atomic<bool>& running)
+{
+    pin_thread(cpu);
+
+    std::vector<wadjet::socket> flows;
+    for(size_t i = 0; i < flows_per_sender; ++i)
+        flows.emplace_back(wadjet::socket_protocol::ipv4, wadjet::socket_flags::none);
+
+    std::array<char, datagram_size> payload = {};
+    while(running.load(std::memory_order_relaxed))
+    {
+        for(auto& flow : flows)
+        {
+            // Ignore failures - the socket may stop accepting data under load.
+            (void)flow.send(destination, std::span{payload});
+        }
+    }
+}
+
+void run_worker(wadjet::socket_group&    group,
+                size_t                   index,
+                int                      cpu,
+                const std::atomic<bool>& running,
+                worker_result&           result)
+{
+    // Pinned workers serve the member which packets processed on their CPU are steered to.
+    if(cpu >= 0)
+    {
+        auto pinned_index = group.pin_current_thread(cpu);
+        if(pinned_index)
+            index = *pinned_index;
+    }
+
+    wadjet::socket_group::member& member = group[index];
+
+    const int counter = open_cache_miss_counter();
+
+    std::array<std::array<char, datagram_size>, wadjet::socket::max_batch_size> storage;
+    std::array<std::span<char>, wadjet::socket::max_batch_size>                 buffers;
+    std::array<wadjet::packet, wadjet::socket::max_batch_size>                  packets;
+    for(size_t i = 0; i < buffers.size(); ++i)
+        buffers[i] = std::span{storage[i]};
+
+    // The first packet of every wakeup lands in the first buffer, and the rest of the queue is
+    // drained in batches.
+    while(running.load(std::memory_order_relaxed))
+    {
+        if(!member.recv_for(buffers[0], std::chrono::milliseconds{10}))
+            continue;
+
+        while(member.recv_batch(buffers, packets))
+            ;
+    }
+
+    result.packets = member.stats().packets_received;
+
+    if(counter >= 0)
+    {
+        uint64_t count = 0;
+        if(::read(counter, &count, sizeof(count)) == sizeof(count))
+        {
+            result.cache_misses = count;
+            result.counted      = true;
+        }
+
+        (void)::close(counter);
+    }
+}
+
+void run_benchmark(const char* name, bool steered)
+{
+    const int cpu_count = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    wadjet::socket_group group{wadjet::socket_protocol::ipv4,
+                               wadjet::socket_flags::none,
+                               wadjet::socket_address::loopback(wadjet::socket_protocol::ipv4),
+                               static_cast<size_t>(cpu_count)};
+
+    if(steered)
+    {
+        auto steer_error = group.steer_by_cpu();
+        if(steer_error != wadjet::error_code::none)
+            throw wadjet::exception{steer_error};
+    }
+
+    std::atomic<bool> receiving = true;
+    std::atomic<bool> sending   = true;
+
+    std::vector<worker_result> results(group.size());
+    std::vector<std::thread>   workers;
+    for(size_t i = 0; i < group.size(); ++i)
+    {
+        const int cpu = steered ? static_cast<int>(i) : -1;
+        workers.emplace_back(
+            run_worker, std::ref(group), i, cpu, std::cref(receiving), std::ref(results[i]));
+    }
+
+    std::vector<std::thread> senders;
+    for(int cpu = 0; cpu < cpu_count; ++cpu)
+        senders.emplace_back(run_sender, cpu, group.address(), std::cref(sending));
+
+    std::this_thread::sleep_for(duration);
+
+    sending = false;
+    for(auto& sender : senders)
+        sender.join();
+
+    receiving = false;
+    for(auto& worker : workers)
+        worker.join();
+
+    uint64_t packets      = 0;
+    uint64_t cache_misses = 0;
+    bool     counted      = true;
+    for(const auto& result : results)
+    {
+        packets += result.packets;
+        cache_misses += result.cache_misses;
+        counted = counted && result.counted;
+    }
+
+    const double seconds = std::chrono::duration<double>(duration).count();
+
+    std::cout << name << ": " << static_cast<double>(packets) / seconds / 1000000 << " Mpps";
+    if(counted && packets > 0)
+    {
+        std::cout << ", " << static_cast<double>(cache_misses) / static_cast<double>(packets)
+                  << " cache misses per packet";
+    }
+    else
+    {
+        std::cout << ", cache miss counters unavailable";
+    }
+    std::cout << std::endl;
+}
+
+} // namespace
+
+int main()
+{
+    try
+    {
+        wadjet::socket_api api;
+
+        run_benchmark("flow-hashed, unpinned workers", false);
+        run_benchmark("cpu-steered, pinned workers", true);
+    }
+    catch(const wadjet::exception& e)
+    {
+        std::cerr << e.what() << ", underlying error: " << e.error().underlying_code << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include <wadjet/io_uring.hpp>
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <span>
+#include <vector>
+
+// Compares the regular sendto/recvfrom path against the io_uring engine, by bouncing rounds of small
+// datagrams between several pairs of loopback sockets. Each round sends datagrams_per_pair
+// datagrams over every pair, and receives all of them.
+
+namespace {
+
+constexpr size_t socket_pairs       = 4;
+constexpr size_t datagrams_per_pair = 16;
+constexpr size_t datagram_size      = 64;
+constexpr size_t rounds             = 20000;
+
+constexpr size_t datagrams_per_round = socket_pairs * datagrams_per_pair;
+
+struct socket_pair
+{
+    wadjet::socket         sender{wadjet::socket_protocol::ipv4, wadjet::socket_flags::none};
+    wadjet::socket         receiver{wadjet::socket_protocol::ipv4, wadjet::socket_flags::none};
+    wadjet::socket_address receiver_address;
+};
+
+template<typename Round>
+void run_benchmark(const char* name, Round&& round)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    for(size_t i = 0; i < rounds; ++i)
+        round();
+
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    const double datagrams = static_cast<double>(datagrams_per_round) * rounds;
+
+    std::cout << name << ": " << datagrams / elapsed.count() / 1000000 << " Mpps (sent and received)"
+              << std::endl;
+}
+
+} // namespace
+
+int main()
+{
+    try
+    {
+        wadjet::socket_api api;
+
+        std::vector<socket_pair> pairs(socket_pairs);
+        for(auto& pair : pairs)
+        {
+            auto bind_error = pair.receiver.bind(wadjet::socket_address::loopback(
+                pair.receiver.protocol()));
+            if(bind_error != wadjet::error_code::none)
+                throw wadjet::exception{bind_error};
+
+            auto address = pair.receiver.address();
+            if(!address)
+                throw wadjet::exception{address.error()};
+
+            pair.receiver_address = *address;
+        }
+
+        std::array<char, datagram_size> payload = {};
+
+        run_benchmark("sendto/recvfrom", [&]() {
+            for(auto& pair : pairs)
+            {
+                for(size_t i = 0; i < datagrams_per_pair; ++i)
+                    (void)pair.sender.send(pair.receiver_address, std::span{payload});
+            }
+
+            std::array<char, datagram_size> buffer;
+            for(auto& pair : pairs)
+            {
+                for(size_t received = 0; received < datagrams_per_pair;)
+                {
+                    if(pair.receiver.recv(std::span{buffer}))
+                        ++received;
+                }
+            }
+        });
+
+        // One registered buffer per operation in flight - sends first, receives second.
+        std::vector<std::array<char, datagram_size>> storage(2 * datagrams_per_round);
+        std::vector<std::span<char>>                 buffers;
+        for(auto& buffer : storage)
+            buffers.push_back(std::span{buffer});
+
+        wadjet::io_uring_engine engine{2 * datagrams_per_round, 2 * socket_pairs, buffers};
+
+        std::vector<size_t> sender_indices;
+        std::vector<size_t> receiver_indices;
+        for(auto& pair : pairs)
+        {
+            auto sender_index = engine.register_socket(pair.sender);
+            if(!sender_index)
+                throw wadjet::exception{sender_index.error()};
+
+            auto receiver_index = engine.register_socket(pair.receiver);
+            if(!receiver_index)
+                throw wadjet::exception{receiver_index.error()};
+
+            sender_indices.push_back(*sender_index);
+            receiver_indices.push_back(*receiver_index);
+        }
+
+        run_benchmark("io_uring", [&]() {
+            // Sends are queued ahead of receives, so the kernel finds the datagrams already waiting
+            // when it processes the receives.
+            size_t buffer_index = 0;
+            for(size_t pair = 0; pair < socket_pairs; ++pair)
+            {
+                for(size_t i = 0; i < datagrams_per_pair; ++i, ++buffer_index)
+                {
+                    (void)engine.prepare_send(sender_indices[pair],
+                                              pairs[pair].receiver_address,
+                                              buffer_index,
+                                              datagram_size,
+                                              buffer_index);
+                }
+            }
+
+            buffer_index = 0;
+            for(size_t pair = 0; pair < socket_pairs; ++pair)
+            {
+                for(size_t i = 0; i < datagrams_per_pair; ++i, ++buffer_index)
+                {
+                    (void)engine.prepare_recv(
+                        receiver_indices[pair], datagrams_per_round + buffer_index, buffer_index);
+                }
+            }
+
+            // A single system call submits the whole round and waits for it to finish.
+            (void)engine.submit(2 * datagrams_per_round);
+
+            for(size_t completed = 0; completed < 2 * datagrams_per_round;)
+            {
+                if(engine.poll_completion())
+                    ++completed;
+                else
+                    (void)engine.submit(1);
+            }
+        });
+    }
+    catch(const wadjet::exception& e)
+    {
+        std::cerr << e.what() << ", underlying error: " << e.error().underlying_code << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,237 @@
+#include <wadjet/socket.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Measures the round-trip latency distribution of small datagrams bounced between two sockets,
+// each served by its own thread, for several ways of waiting for packets. Spinning needs a core
+// per thread to pay off.
+//
+// By default, both sides run on this host, over loopback. Loopback has no device to poll, so busy
+// polling can't help there - to measure it, run an echo server on another host, and point the
+// benchmark at that host's NIC address:
+//
+//     ping_pong_benchmark echo <port>          (on the remote host)
+//     ping_pong_benchmark <address> <port>     (on this host)
+//
+// The echo server always spins and busy polls, so only the waiting of this host varies.
+
+namespace {
+
+constexpr size_t datagram_size = 64;
+constexpr size_t warmup        = 1000;
+constexpr size_t round_trips   = 20000;
+
+constexpr auto timeout = std::chrono::milliseconds{1000};
+
+enum class wait_mode
+{
+    sleep,
+    spin,
+    busy_poll
+};
+
+wadjet::expected<wadjet::packet, wadjet::error> wait_for_packet(const wadjet::socket& socket,
+                                                                std::span<char>       buffer,
+                                                                wait_mode             mode,
+                                                                wadjet::spin_wait&    wait)
+{
+    if(mode == wait_mode::sleep)
+        return socket.recv_for(buffer, timeout);
+
+    return socket.recv_adaptive(buffer, wait, timeout);
+}
+
+// Enables busy polling on the socket, if the mode asks for it. Returns false if it's unavailable.
+bool prepare_socket(const char* name, const wadjet::socket& socket, wait_mode mode)
+{
+    if(mode != wait_mode::busy_poll)
+        return true;
+
+    auto busy_poll_error = socket.set_busy_poll(std::chrono::microseconds{50}, true);
+    if(busy_poll_error != wadjet::error_code::none)
+    {
+        std::cout << name << ": unavailable, underlying error: " << busy_poll_error.underlying_code
+                  << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Sends every received packet back, until running is cleared.
+void echo(const wadjet::socket& server, wait_mode mode, const std::atomic<bool>& running)
+{
+    wadjet::spin_wait               wait;
+    std::array<char, datagram_size> buffer;
+    while(running.load(std::memory_order_relaxed))
+    {
+        auto packet = wait_for_packet(server, std::span{buffer}, mode, wait);
+        if(packet)
+            (void)server.send(packet->address, packet->payload);
+    }
+}
+
+double percentile(const std::vector<double>& sorted, double fraction)
+{
+    const size_t index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1));
+    return sorted[index];
+}
+
+// Bounces datagrams off the echo server at the destination, and prints the latency distribution.
+void measure(const char*           name,
+             const wadjet::socket& client,
+             wadjet::socket_address destination,
+             wait_mode             mode)
+{
+    wadjet::spin_wait               wait;
+    std::array<char, datagram_size> payload = {};
+    std::array<char, datagram_size> buffer;
+
+    std::vector<double> latencies;
+    latencies.reserve(round_trips);
+
+    for(size_t i = 0; i < warmup + round_trips; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        auto send_error = client.send(destination, std::span{payload});
+        if(send_error != wadjet::error_code::none)
+            throw wadjet::exception{send_error};
+
+        auto reply = wait_for_packet(client, std::span{buffer}, mode, wait);
+        if(!reply)
+            throw wadjet::exception{reply.error()};
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        if(i >= warmup)
+            latencies.push_back(std::chrono::duration<double, std::micro>(elapsed).count());
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << name << ": p50 " << percentile(latencies, 0.5) << " us, p99 "
+              << percentile(latencies, 0.99) << " us, p99.9 " << percentile(latencies, 0.999)
+              << " us, max " << latencies.back() << " us" << std::endl;
+}
+
+// Runs both sides on this host, over loopback.
+void run_local(const char* name, wait_mode mode)
+{
+    wadjet::socket client{wadjet::socket_protocol::ipv4, wadjet::socket_flags::none};
+    wadjet::socket server{wadjet::socket_protocol::ipv4, wadjet::socket_flags::none};
+
+    for(const wadjet::socket* socket : {&client, &server})
+    {
+        auto bind_error = socket->bind(wadjet::socket_address::loopback(socket->protocol()));
+        if(bind_error != wadjet::error_code::none)
+            throw wadjet::exception{bind_error};
+
+        if(!prepare_socket(name, *socket, mode))
+            return;
+    }
+
+    auto server_address = server.address();
+    if(!server_address)
+        throw wadjet::exception{server_address.error()};
+
+    std::atomic<bool> running = true;
+    std::thread       echo_thread([&]() { echo(server, mode, running); });
+
+    measure(name, client, *server_address, mode);
+
+    // Wake the echo thread up, so that it notices the benchmark is over.
+    running = false;
+
+    std::array<char, datagram_size> payload = {};
+    (void)client.send(*server_address, std::span{payload});
+    echo_thread.join();
+}
+
+// Runs this host's side against an echo server on another host.
+void run_remote(const char* name, wait_mode mode, wadjet::socket_address destination)
+{
+    wadjet::socket client{wadjet::socket_protocol::ipv4, wadjet::socket_flags::none};
+
+    auto bind_error = client.bind(wadjet::socket_address::any(client.protocol()));
+    if(bind_error != wadjet::error_code::none)
+        throw wadjet::exception{bind_error};
+
+    if(!prepare_socket(name, client, mode))
+        return;
+
+    measure(name, client, destination, mode);
+}
+
+// Serves as the remote side of the benchmark, until killed.
+void run_echo_server(uint16_t port)
+{
+    wadjet::socket server{wadjet::socket_protocol::ipv4, wadjet::socket_flags::none};
+
+    auto bind_error = server.bind(wadjet::socket_address::any(server.protocol(), port));
+    if(bind_error != wadjet::error_code::none)
+        throw wadjet::exception{bind_error};
+
+    // Fall back to plain spinning where busy polling is unavailable.
+    const wait_mode mode =
+        prepare_socket("echo server busy polling", server, wait_mode::busy_poll)
+            ? wait_mode::busy_poll
+            : wait_mode::spin;
+
+    std::cout << "echoing on port " << port << std::endl;
+
+    const std::atomic<bool> running = true;
+    echo(server, mode, running);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        wadjet::socket_api api;
+
+        if(argc == 3 && std::string_view{argv[1]} == "echo")
+        {
+            run_echo_server(static_cast<uint16_t>(std::atoi(argv[2])));
+            return 0;
+        }
+
+        if(argc == 3)
+        {
+            const wadjet::socket_address destination{
+                wadjet::socket_protocol::ipv4, argv[1], static_cast<uint16_t>(std::atoi(argv[2]))};
+
+            run_remote("sleep (recv_for)", wait_mode::sleep, destination);
+            run_remote("spin then sleep (recv_adaptive)", wait_mode::spin, destination);
+            run_remote("spin then sleep, busy polling", wait_mode::busy_poll, destination);
+            return 0;
+        }
+
+        if(argc != 1)
+        {
+            std::cerr << "usage: ping_pong_benchmark [echo <port> | <address> <port>]" << std::endl;
+            return 1;
+        }
+
+        // Over loopback, busy polling has nothing to poll, so it's left out.
+        run_local("sleep (recv_for)", wait_mode::sleep);
+        run_local("spin then sleep (recv_adaptive)", wait_mode::spin);
+    }
+    catch(const wadjet::exception& e)
+    {
+        std::cerr << e.what() << ", underlying error: " << e.error().underlying_code << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
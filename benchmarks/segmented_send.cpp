@@ -0,0 +1,92 @@
+#include <wadjet/socket.hpp>
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <span>
+#include <vector>
+
+// Compares sending a large buffer over loopback as a series of individual datagrams versus a single
+// segmented send. Only the sender is measured - the receiver merely keeps the destination port
+// open, so the kernel is free to drop datagrams once its receive buffer fills up.
+
+namespace {
+
+constexpr size_t segment_size = 1400;
+constexpr size_t buffer_size  = 64 * segment_size;
+constexpr size_t iterations   = 20000;
+
+// The send callback returns the number of bytes actually sent, so that partial and failed sends
+// aren't counted.
+template<typename Send>
+void run_benchmark(const char* name, Send&& send)
+{
+    size_t sent_bytes     = 0;
+    size_t sent_datagrams = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        const size_t sent = send();
+        sent_bytes += sent;
+        sent_datagrams += (sent + segment_size - 1) / segment_size;
+    }
+
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    const double bytes     = static_cast<double>(sent_bytes);
+    const double datagrams = static_cast<double>(sent_datagrams);
+
+    std::cout << name << ": " << bytes / elapsed.count() / (1024 * 1024) << " MiB/s, "
+              << datagrams / elapsed.count() / 1000000 << " Mpps" << std::endl;
+}
+
+} // namespace
+
+int main()
+{
+    try
+    {
+        wadjet::socket_api api;
+
+        wadjet::socket sender{wadjet::socket_protocol::ipv4, wadjet::socket_flags::none};
+        wadjet::socket receiver{wadjet::socket_protocol::ipv4, wadjet::socket_flags::none};
+
+        auto bind_error = receiver.bind(wadjet::socket_address::loopback(receiver.protocol()));
+        if(bind_error != wadjet::error_code::none)
+            throw wadjet::exception{bind_error};
+
+        auto receiver_address = receiver.address();
+        if(!receiver_address)
+            throw wadjet::exception{receiver_address.error()};
+
+        const std::vector<char> buffer(buffer_size, 'x');
+        const auto              payload = std::span{buffer};
+
+        run_benchmark("individual datagrams", [&]() {
+            size_t sent = 0;
+            for(size_t offset = 0; offset < payload.size(); offset += segment_size)
+            {
+                // The socket may stop accepting data under load - only count what went through.
+                const auto segment = payload.subspan(offset, segment_size);
+                if(sender.send(*receiver_address, segment) == wadjet::error_code::none)
+                    sent += segment.size();
+            }
+
+            return sent;
+        });
+
+        run_benchmark("segmented send", [&]() {
+            auto sent = sender.send_segmented(*receiver_address, payload, segment_size);
+            return sent ? *sent : size_t{0};
+        });
+    }
+    catch(const wadjet::exception& e)
+    {
+        std::cerr << e.what() << ", underlying error: " << e.error().underlying_code << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -24,6 +24,10 @@ telemetry_client::telemetry_client(const char* server_ip, uint16_t server_port)
     socket(wadjet::socket_protocol::ipv4, wadjet::socket_flags::dual_stack),
     server_address(socket.protocol(), server_ip, server_port)
 {
+    // The client only ever talks to the server, so let the kernel look the route up once.
+    auto connect_error = socket.connect(server_address);
+    if(connect_error != wadjet::error_code::none)
+        throw wadjet::exception{connect_error};
 }
 
 void telemetry_client::send_telemetry(std::string_view text)
@@ -34,7 +38,7 @@ void telemetry_client::send_telemetry(std::string_view text)
     // you'll probably want a proper serialization to byte stream rather than reinterpret_cast.
     const auto packet_span = std::span{(const char*)&packet, sizeof(packet)};
 
-    auto send_error = socket.send(server_address, packet_span);
+    auto send_error = socket.send(packet_span);
     if(send_error != wadjet::error_code::none)
     {
         // Propagate error in form of exception.
@@ -39,7 +39,10 @@ void telemetry_server::run()
         // This isn't recommended due to potential padding and endianness issues. In real-life
         // scenario, you'll probably want a proper serialization to byte stream rather than
         // reinterpret_cast.
-        auto result = socket.recv(std::span<char>{(char*)&packet, sizeof(packet)});
+        //
+        // Rather than spinning on recv, sleep until a packet arrives.
+        auto result = socket.recv_for(std::span<char>{(char*)&packet, sizeof(packet)},
+                                      std::chrono::milliseconds{-1});
         if(!result && result.error() != wadjet::error_code::socket_would_block)
         {
             // Propagate error in form of exception.
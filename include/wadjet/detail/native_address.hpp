@@ -0,0 +1,68 @@
+#pragma once
+
+#include <wadjet/detail/posix.hpp>
+#include <wadjet/network.hpp>
+
+#include <cstring>
+
+namespace wadjet {
+namespace detail {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Native address helpers.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Storage for any native address a socket can consume or produce.
+union native_address
+{
+    ::sockaddr     generic;
+    ::sockaddr_in  ipv4;
+    ::sockaddr_in6 ipv6;
+};
+
+// Length of the native address used by sockets of the given protocol.
+inline socklen_t native_address_length(socket_protocol protocol) noexcept
+{
+    return protocol == socket_protocol::ipv6 ? sizeof(::sockaddr_in6) : sizeof(::sockaddr_in);
+}
+
+// Fills the native address from a socket_address and returns its length.
+inline socklen_t to_native_address(socket_protocol       protocol,
+                                   const socket_address& address,
+                                   native_address&       native) noexcept
+{
+    if(protocol == socket_protocol::ipv6)
+    {
+        native.ipv6             = {};
+        native.ipv6.sin6_family = AF_INET6;
+        native.ipv6.sin6_port   = address.port_network_order();
+
+        std::memcpy(&native.ipv6.sin6_addr, address.ipv6().data(), address.ipv6().size());
+    }
+    else
+    {
+        native.ipv4                 = {};
+        native.ipv4.sin_family      = AF_INET;
+        native.ipv4.sin_port        = address.port_network_order();
+        native.ipv4.sin_addr.s_addr = address.ipv4();
+    }
+
+    return native_address_length(protocol);
+}
+
+// Converts a native address, as filled in by the socket API, into a socket_address.
+inline socket_address from_native_address(socket_protocol       protocol,
+                                          const native_address& native) noexcept
+{
+    if(protocol == socket_protocol::ipv6)
+    {
+        return socket_address{
+            std::span{(const uint8_t*)&native.ipv6.sin6_addr, sizeof(native.ipv6.sin6_addr)},
+            ntohs(native.ipv6.sin6_port)};
+    }
+
+    return socket_address{ntohl(native.ipv4.sin_addr.s_addr), ntohs(native.ipv4.sin_port)};
+}
+
+} // namespace detail
+} // namespace wadjet
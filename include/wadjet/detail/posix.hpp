@@ -13,9 +13,18 @@
 #include <netinet/ip.h>
 #include <arpa/inet.h>
 #include <fcntl.h>
+#include <sys/ioctl.h>
+#include <poll.h>
 #include <unistd.h>
 #include <cerrno>
 
+#ifdef __linux__
+#include <netinet/udp.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <linux/sock_diag.h>
+#endif
+
 #endif
 
 namespace wadjet {
@@ -25,7 +25,19 @@ enum class error_code
     socket_send_error,
     socket_recv_error,
     socket_would_block,
-    socket_address_conversion_fail
+    socket_address_conversion_fail,
+    socket_option_unavailable,
+    io_uring_setup_fail,
+    io_uring_registration_fail,
+    io_uring_submission_queue_full,
+    io_uring_submit_fail,
+    poller_creation_fail,
+    poller_registration_fail,
+    poller_wait_fail,
+    socket_option_query_fail,
+    thread_affinity_fail,
+    socket_connect_error,
+    multicast_membership_fail
 };
 
 // Error code returned from within Winsock or POSIX socket API.
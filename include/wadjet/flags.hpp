@@ -13,7 +13,44 @@ namespace wadjet {
 enum class socket_flags : uint64_t
 {
     none       = 0ULL,
-    dual_stack = 1ULL
+    dual_stack = 1ULL,
+
+    // Let the kernel coalesce same-flow datagrams into a single received packet (UDP_GRO). See
+    // packet::segments. Linux only.
+    udp_gro = 1ULL << 1,
+
+    // Allow multiple sockets to bind to the same address (SO_REUSEPORT), with the kernel
+    // distributing incoming flows between them. See socket_group. Not available on Windows.
+    reuse_port = 1ULL << 2,
+
+    // Allow sending without copying the payload into the kernel (SO_ZEROCOPY). See
+    // socket::send_zerocopy. Linux only.
+    zerocopy = 1ULL << 3,
+
+    // Record the time at which the kernel received each packet (SO_TIMESTAMPNS). See
+    // packet::timestamp. Linux only.
+    rx_timestamps = 1ULL << 4,
+
+    // Record the times at which the kernel schedules and transmits each sent datagram
+    // (SO_TIMESTAMPING). See socket::poll_tx_timestamp. Linux only.
+    tx_timestamps = 1ULL << 5,
+
+    // Report the number of packets the kernel dropped on the socket alongside each received packet
+    // (SO_RXQ_OVFL). See packet::dropped. Linux only.
+    drop_counter = 1ULL << 6,
+
+    // Report the local address each received packet was sent to, and the interface it arrived on
+    // (IP_PKTINFO/IPV6_RECVPKTINFO). See packet::destination. Linux only.
+    packet_info = 1ULL << 7,
+
+    // Report the traffic class byte (IPV4 TOS or IPV6 TCLASS) of each received packet, which
+    // carries its ECN codepoint (IP_RECVTOS/IPV6_RECVTCLASS). See packet::ecn. Linux only.
+    ecn = 1ULL << 8,
+
+    // Allow scheduling the departure time of each sent datagram (SO_TXTIME, against the monotonic
+    // clock). See socket::send_at and outgoing_packet::departure. Departure times are enforced by
+    // the fq and etf queueing disciplines, and ignored by others. Linux only.
+    txtime = 1ULL << 9
 };
 
 WADJET_BITMASK(socket_flags);
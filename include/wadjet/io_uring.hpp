@@ -0,0 +1,169 @@
+#pragma once
+
+// The io_uring engine is only available on Linux, if wadjet is built with WADJET_IO_URING enabled.
+
+#include <wadjet/detail/linking.hpp>
+#include <wadjet/errors.hpp>
+#include <wadjet/network.hpp>
+#include <wadjet/expected.hpp>
+#include <wadjet/socket.hpp>
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <span>
+
+namespace wadjet {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// I/O completion.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+enum class io_operation
+{
+    send,
+    recv,
+    multishot_recv,
+    cancel
+};
+
+// Describes a finished io_uring_engine operation.
+struct WADJET_DLL io_completion
+{
+    // Buffer index of completions which don't carry a buffer, e.g. failed multishot receives.
+    inline static constexpr size_t no_buffer = SIZE_MAX;
+
+    // Kind of the finished operation.
+    io_operation operation;
+
+    // User-provided value identifying the operation.
+    uint64_t user_data;
+
+    // Index of the socket the operation was performed on.
+    size_t socket_index;
+
+    // Index of the registered buffer used by the operation. For multishot receives, this is the ID
+    // of the buffer pool buffer holding the packet, which must be recycled once processed. Only
+    // successful multishot receives carry a buffer - for others, and for cancellations, this is
+    // no_buffer.
+    size_t buffer_index;
+
+    // Whether the operation keeps producing completions. Only multishot receives do that, until
+    // they are cancelled, fail, or the buffer pool runs dry.
+    bool active;
+
+    // Outcome of the operation - error_code::none if it succeeded.
+    error result;
+
+    // Destination of a sent packet, or the address from which a received packet came from.
+    socket_address address;
+
+    // A view into the registered buffer. Represents sent or received packet contents.
+    std::span<char> payload;
+
+    // Whether a received packet didn't fit into the buffer, and was cut short.
+    bool truncated = false;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// io_uring engine.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// An alternative I/O engine, which submits sends and receives on many sockets to the kernel in
+// batches, and reaps their completions without a system call per operation. Sockets and buffers
+// are registered with the kernel up front, so operations refer to them by index.
+//
+// Operations are prepared with prepare_send and prepare_recv, and handed to the kernel all at once
+// with submit. Finished operations can then be processed with poll_completion. The engine isn't
+// thread-safe.
+class WADJET_DLL io_uring_engine
+{
+public:
+    // Zero-copy threshold which disables zero-copy sends.
+    inline static constexpr size_t no_zero_copy = SIZE_MAX;
+
+    // Creates an engine which can have up to queue_size operations in flight, and up to
+    // max_sockets sockets registered. Buffers are user-provided, and must outlive the engine.
+    // Throws on failure.
+    io_uring_engine(unsigned int                     queue_size,
+                    size_t                           max_sockets,
+                    std::span<const std::span<char>> buffers);
+    ~io_uring_engine();
+
+    // Disable copy - the engine exclusively owns the kernel resources.
+    io_uring_engine(const io_uring_engine& other) = delete;
+    io_uring_engine& operator=(const io_uring_engine& other) = delete;
+
+    io_uring_engine(io_uring_engine&& other) noexcept;
+    io_uring_engine& operator=(io_uring_engine&& other) noexcept;
+
+    // Registers the socket with the engine, returning its index. The socket must stay alive until
+    // it's unregistered, and all of its operations have completed.
+    expected<size_t, error> register_socket(const socket& socket) noexcept;
+
+    // Removes the socket with the provided index from the engine.
+    error unregister_socket(size_t socket_index) noexcept;
+
+    // Returns a view into the registered buffer with the provided index.
+    std::span<char> buffer(size_t buffer_index) const noexcept;
+
+    // Sends of at least min_size bytes are performed straight from the registered buffer, which
+    // must not be modified until they complete (IORING_OP_SEND_ZC, Linux 6.0). Each zero-copy send
+    // costs an extra completion and pins its pages, which only pays off for large payloads sent
+    // through a device - smaller sends, and all sends over loopback, are better off copied.
+    // Disabled (no_zero_copy) by default. Returns error_code::io_uring_setup_fail if the kernel
+    // doesn't support zero-copy sends.
+    error set_zero_copy_threshold(size_t min_size) noexcept;
+
+    // Prepares a send of the first size bytes of a registered buffer to the destination. The
+    // packet is copied into the kernel upon submission, unless it's sent zero-copy (see
+    // set_zero_copy_threshold). Returns error_code::io_uring_submission_queue_full if too many
+    // operations are pending.
+    error prepare_send(size_t         socket_index,
+                       socket_address destination,
+                       size_t         buffer_index,
+                       size_t         size,
+                       uint64_t       user_data) noexcept;
+
+    // Prepares a receive of a single packet into a registered buffer. Receives are always copied
+    // into the buffer, since fixed-buffer receives can't report the source of the packet.
+    // Returns error_code::io_uring_submission_queue_full if too many operations are pending.
+    error prepare_recv(size_t socket_index, size_t buffer_index, uint64_t user_data) noexcept;
+
+    // Creates a pool of buffer_count buffers of buffer_size bytes each, owned by the engine. The
+    // kernel picks buffers from the pool for multishot receives. Each buffer also holds the source
+    // address of a packet, so it should be somewhat larger than the largest expected payload.
+    // buffer_count must be a power of two, no larger than 32768. Can only be called once.
+    error create_buffer_pool(uint16_t buffer_count, size_t buffer_size) noexcept;
+
+    // Prepares a multishot receive - once submitted, it keeps producing a completion for every
+    // received packet, each one carrying a buffer pool buffer, until cancelled. This avoids both a
+    // system call and a submission per packet. Requires a buffer pool. Completions can pile up
+    // beyond the queue size, in which case the kernel holds on to those which don't fit until
+    // they're polled - newer kernels also end the receive, which then has to be prepared again.
+    error prepare_multishot_recv(size_t socket_index, uint64_t user_data) noexcept;
+
+    // Prepares a cancellation of the in-flight operation with the provided user data - the
+    // cancelled operation completes with an error. The cancellation itself also produces a
+    // completion, carrying the same user data.
+    error prepare_cancel(uint64_t user_data) noexcept;
+
+    // Hands a buffer pool buffer back to the kernel, once the packet it holds has been processed.
+    void recycle_buffer(size_t buffer_id) noexcept;
+
+    // Submits all prepared operations with a single system call, and waits until at least
+    // min_completions operations have completed. Returns the number of submitted operations.
+    expected<size_t, error> submit(unsigned int min_completions = 0) noexcept;
+
+    // Returns the next finished operation, if any.
+    std::optional<io_completion> poll_completion() noexcept;
+
+private:
+    // Kernel ring state and per-operation bookkeeping, kept out of the header.
+    struct ring;
+
+    std::unique_ptr<ring> ring_m;
+};
+
+} // namespace wadjet
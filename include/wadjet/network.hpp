@@ -5,6 +5,9 @@
 #include <wadjet/expected.hpp>
 #include <wadjet/errors.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <iterator>
 #include <span>
 #include <cstdint>
 #include <cstddef>
@@ -38,6 +41,10 @@ public:
     // the terminating null character.
     inline static constexpr size_t ipv6_string_size = 45 + 1;
 
+    // Create an unspecified IPV4 address (0.0.0.0) with port zero. Mostly useful as a placeholder
+    // for storage which is filled in later, e.g. by socket::recv_batch.
+    socket_address() noexcept;
+
     // Create an address from raw IPV4 and port. IPV4 and port are in host order.
     socket_address(uint32_t ipv4, uint16_t port) noexcept;
 
@@ -84,6 +91,13 @@ public:
     // Returns the raw IPV4 in network order.
     uint32_t ipv4() const noexcept;
 
+    // Protocol the address was created for.
+    socket_protocol protocol() const noexcept;
+
+    // Whether the address is a multicast group address (224.0.0.0/4 or ff00::/8). IPV4-mapped
+    // IPV6 addresses are checked as IPV4.
+    bool is_multicast() const noexcept;
+
 private:
     // Makes IPV6 <-> IPV4 interoperability easier.
     struct mapped_ipv4
@@ -104,27 +118,283 @@ private:
     };
 
     // Port is kept in network order.
-    const uint16_t port_m;
+    uint16_t port_m;
+
+    socket_protocol protocol_m;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Socket endpoint.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+class socket;
+
+// A socket address, already converted into the native form consumed by sockets of a given
+// protocol. Sending to an endpoint, or receiving the source of a packet into one, does no address
+// conversion at all - useful for hot loops talking to known peers.
+class WADJET_DLL socket_endpoint
+{
+public:
+    // Large enough for any native address a socket can consume or produce.
+    inline static constexpr size_t storage_size = 28;
+
+    // Create an empty endpoint. Mostly useful as storage which is filled in later, e.g. by
+    // socket::recv.
+    socket_endpoint() noexcept;
+
+    // Create an endpoint usable by sockets of the provided protocol. For dual-stack IPV6 sockets,
+    // IPV4 addresses are mapped.
+    socket_endpoint(socket_protocol protocol, socket_address address) noexcept;
+
+    // Protocol of the sockets the endpoint is usable by.
+    socket_protocol protocol() const noexcept;
+
+    // Converts the endpoint back into an address.
+    socket_address address() const noexcept;
+
+    // Compares the native addresses, without converting them.
+    bool operator==(const socket_endpoint& other) const noexcept;
+
+private:
+    friend class socket;
+
+    alignas(8) unsigned char storage_m[storage_size];
+
+    // Length of the native address held by the storage.
+    uint32_t size_m;
 
-    const socket_protocol protocol_m;
+    socket_protocol protocol_m;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Packet segments.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// A view over the individual datagrams contained in a coalesced payload. Every segment is
+// segment_size bytes long, except for the last one, which may be shorter.
+class packet_segments
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = std::span<char>;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = std::span<char>;
+
+        inline iterator() noexcept : remaining_m(), segment_size_m(0)
+        {
+        }
+
+        inline iterator(std::span<char> remaining, size_t segment_size) noexcept :
+            remaining_m(remaining), segment_size_m(segment_size)
+        {
+        }
+
+        inline std::span<char> operator*() const noexcept
+        {
+            return remaining_m.first(std::min(segment_size_m, remaining_m.size()));
+        }
+
+        inline iterator& operator++() noexcept
+        {
+            remaining_m = remaining_m.subspan(std::min(segment_size_m, remaining_m.size()));
+            return *this;
+        }
+
+        inline iterator operator++(int) noexcept
+        {
+            iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        inline bool operator==(const iterator& other) const noexcept
+        {
+            return remaining_m.size() == other.remaining_m.size();
+        }
+
+    private:
+        // Part of the payload which hasn't been iterated over yet.
+        std::span<char> remaining_m;
+
+        size_t segment_size_m;
+    };
+
+    inline packet_segments(std::span<char> payload, size_t segment_size) noexcept :
+        payload_m(payload), segment_size_m(segment_size)
+    {
+    }
+
+    inline iterator begin() const noexcept
+    {
+        return iterator{payload_m, segment_size_m};
+    }
+
+    inline iterator end() const noexcept
+    {
+        return iterator{payload_m.last(0), segment_size_m};
+    }
+
+private:
+    std::span<char> payload_m;
+    size_t          segment_size_m;
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // Packet structure.
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
+// Explicit Congestion Notification codepoint, held by the two lowest bits of the traffic class
+// byte (RFC 3168).
+enum class ecn_codepoint : uint8_t
+{
+    // The sender doesn't support ECN.
+    not_ect = 0b00,
+
+    // ECN capable transport, as used by L4S.
+    ect1 = 0b01,
+
+    // ECN capable transport.
+    ect0 = 0b10,
+
+    // Congestion experienced - set by a router instead of dropping the packet.
+    ce = 0b11
+};
+
 struct WADJET_DLL packet
 {
+    // Creates an empty packet. Useful for preallocating storage for batched operations.
+    inline packet() : address(), payload(), full_size(0), destination()
+    {
+    }
+
     inline packet(socket_address address, std::span<char> payload) :
-        address(address), payload(payload)
+        address(address), payload(payload), full_size(payload.size()), destination()
     {
     }
 
+    // Returns a view over the individual datagrams in the payload. Unless the kernel coalesced
+    // multiple datagrams into this packet (see socket_flags::udp_gro), there is exactly one.
+    inline packet_segments segments() const noexcept
+    {
+        return packet_segments{payload, segment_size != 0 ? segment_size : payload.size()};
+    }
+
+    // Returns the ECN codepoint of the traffic class byte.
+    inline ecn_codepoint ecn() const noexcept
+    {
+        return static_cast<ecn_codepoint>(traffic_class & 0b11);
+    }
+
     // Address from which the packet came from.
     socket_address address;
 
     // A view into the user-provided buffer. Represents packet contents.
     std::span<char> payload;
+
+    // Size of the whole packet. If it didn't fit into the buffer, it's larger than the payload,
+    // which holds as much of it as fitted. Where the platform doesn't report the size of truncated
+    // packets (Windows), it matches the payload size.
+    size_t full_size;
+
+    // Whether the packet didn't fit into the buffer, and was cut short.
+    bool truncated = false;
+
+    // Local address the packet was sent to, if the socket was created with
+    // socket_flags::packet_info. Useful for sockets bound to all interfaces, e.g. to reply from
+    // the address the peer talked to. The port isn't reported, and is zero.
+    socket_address destination;
+
+    // Index of the interface the packet arrived on, if the socket was created with
+    // socket_flags::packet_info, or zero otherwise.
+    uint32_t interface_index = 0;
+
+    // Size of the individual datagrams if the payload was coalesced by the kernel, or zero if the
+    // payload is a single datagram.
+    size_t segment_size = 0;
+
+    // Time at which the kernel received the packet, if the socket was created with
+    // socket_flags::rx_timestamps, or the clock's epoch otherwise. Comparing it against the time
+    // of processing reveals how long the packet was queued in the socket.
+    std::chrono::system_clock::time_point timestamp = {};
+
+    // Number of packets the kernel dropped on the socket so far, e.g. because its receive buffer
+    // was full, if the socket was created with socket_flags::drop_counter. The counter is
+    // cumulative, so the difference between two packets tells how many were lost in between.
+    uint32_t dropped = 0;
+
+    // Traffic class byte (IPV4 TOS or IPV6 TCLASS) the packet arrived with, if the socket was
+    // created with socket_flags::ecn, or zero otherwise. The upper six bits hold the DSCP, and
+    // the lower two the ECN codepoint - see ecn.
+    uint8_t traffic_class = 0;
+};
+
+// Describes a packet to be sent as part of a batch.
+struct WADJET_DLL outgoing_packet
+{
+    // Address to which the packet should be sent.
+    socket_address address;
+
+    // A view into the user-provided buffer. Represents packet contents.
+    std::span<const char> payload;
+
+    // Earliest time at which the packet may leave, if the socket was created with
+    // socket_flags::txtime. The clock's epoch sends the packet right away.
+    std::chrono::steady_clock::time_point departure = {};
+};
+
+// Reports that a range of zero-copy sends has completed, and that their buffers may be reused.
+struct WADJET_DLL zerocopy_completion
+{
+    // IDs of the first and the last completed send, inclusive. The range may wrap around.
+    uint32_t first = 0;
+    uint32_t last  = 0;
+
+    // Whether the kernel had to copy the payloads after all, e.g. because they were sent over
+    // loopback or to a device without scatter-gather support. If this keeps happening, plain sends
+    // are cheaper.
+    bool copied = false;
+
+    // Whether the send with the provided ID is within the completed range.
+    constexpr bool covers(uint32_t id) const noexcept { return id - first <= last - first; }
+};
+
+// Describes how much of the socket buffers is occupied. All sizes are in bytes, and include the
+// bookkeeping overhead of the kernel.
+struct WADJET_DLL buffer_occupancy
+{
+    // Packets waiting to be received, and the size of the receive buffer.
+    size_t recv_queued = 0;
+    size_t recv_size   = 0;
+
+    // Packets waiting to be transmitted, and the size of the send buffer.
+    size_t send_queued = 0;
+    size_t send_size   = 0;
+};
+
+// Point of the kernel transmit path at which a sent datagram was timestamped.
+enum class tx_timestamp_stage
+{
+    // The datagram entered the queueing discipline of the device.
+    scheduled,
+
+    // The datagram was handed to the device driver.
+    sent
+};
+
+// Reports the time at which a sent datagram reached a point of the kernel transmit path.
+struct WADJET_DLL tx_timestamp
+{
+    // ID of the send. Every successful send call on the socket consumes one, starting from zero -
+    // batched sends consume one per datagram.
+    uint32_t id = 0;
+
+    tx_timestamp_stage stage = tx_timestamp_stage::sent;
+
+    std::chrono::system_clock::time_point timestamp = {};
 };
 
 } // namespace wadjet
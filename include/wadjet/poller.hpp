@@ -0,0 +1,103 @@
+#pragma once
+
+// The poller is only available on Linux, since it's built on top of epoll.
+
+#include <wadjet/detail/bitmask.hpp>
+#include <wadjet/detail/linking.hpp>
+#include <wadjet/errors.hpp>
+#include <wadjet/expected.hpp>
+#include <wadjet/socket.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <map>
+
+namespace wadjet {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Poll events.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+enum class poll_events : uint32_t
+{
+    none     = 0U,
+    readable = 1U << 0,
+    writable = 1U << 1,
+
+    // Reported regardless of whether it was requested.
+    error = 1U << 2
+};
+
+WADJET_BITMASK(poll_events);
+
+enum class poll_mode
+{
+    // Sockets are reported for as long as they're ready.
+    level_triggered,
+
+    // Sockets are reported only when they become ready, so callbacks should drain them until
+    // error_code::socket_would_block is returned.
+    edge_triggered
+};
+
+// Invoked with a socket which is ready, along with the events it's ready for.
+using poll_callback = std::function<void(const socket& socket, poll_events events)>;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Poller.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Waits for readiness of many sockets at once, and dispatches ready sockets to their callbacks.
+// Since wadjet sockets are non-blocking, this allows sleeping until there's work to do rather than
+// spinning on socket::recv. Waiting allocates nothing - events are gathered into a fixed array of
+// max_events entries.
+class WADJET_DLL poller
+{
+public:
+    // Maximum number of events processed by a single wait.
+    inline static constexpr size_t max_events = 64;
+
+    // Throws on failure.
+    poller();
+    ~poller();
+
+    // Disable copy - the poller exclusively owns the underlying epoll instance.
+    poller(const poller& other) = delete;
+    poller& operator=(const poller& other) = delete;
+
+    poller(poller&& other) noexcept;
+    poller& operator=(poller&& other) noexcept;
+
+    // Starts watching the socket for the provided events. The socket must not be moved or
+    // destroyed while it's registered.
+    error add(const socket& socket, poll_events events, poll_mode mode, poll_callback callback);
+
+    // Changes the events and mode of an already registered socket.
+    error modify(const socket& socket, poll_events events, poll_mode mode) noexcept;
+
+    // Stops watching the socket. Safe to call from within a callback, even for the socket being
+    // dispatched.
+    error remove(const socket& socket) noexcept;
+
+    // Waits until at least one socket is ready, or until the timeout expires, and dispatches ready
+    // sockets to their callbacks. A negative timeout waits indefinitely. Returns the number of
+    // dispatched sockets, which is zero if the timeout expired or the wait was interrupted.
+    expected<size_t, error> wait(std::chrono::milliseconds timeout);
+
+private:
+    struct registration
+    {
+        const wadjet::socket* watched;
+        poll_callback         callback;
+    };
+
+    // Handle of the underlying epoll instance.
+    int handle_m;
+
+    // Registered sockets, keyed by their native handle.
+    std::map<socket::handle_t, registration> registrations_m;
+};
+
+} // namespace wadjet
@@ -6,6 +6,8 @@
 #include <wadjet/network.hpp>
 #include <wadjet/expected.hpp>
 
+#include <chrono>
+
 namespace wadjet {
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -31,6 +33,22 @@ private:
     bool initialized_m;
 };
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Spin wait.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// State of an adaptive spin-then-sleep wait - see socket::recv_adaptive. Each receiving thread
+// should keep its own.
+struct WADJET_DLL spin_wait
+{
+    // Upper bound on how long a wait spins before going to sleep.
+    std::chrono::nanoseconds max_spin = std::chrono::microseconds{50};
+
+    // How long the next wait spins. Grows while packets keep arriving during spins, and shrinks
+    // while they don't.
+    std::chrono::nanoseconds spin = max_spin;
+};
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // IPV4/IPV6 socket.
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -39,6 +57,17 @@ private:
 class WADJET_DLL socket
 {
 public:
+    // Maximum number of datagrams processed by a single batched operation. Batch bookkeeping is
+    // kept on the stack, so this also bounds the stack usage of batched calls.
+    inline static constexpr size_t max_batch_size = 64;
+
+    // Maximum number of separate buffers a single datagram can be gathered from, or scattered
+    // into. Like batch bookkeeping, the buffer descriptors are kept on the stack.
+    inline static constexpr size_t max_buffer_count = 16;
+
+    // Handle provided by underlying socket API.
+    using handle_t = int;
+
     socket(socket_protocol protocol, socket_flags flags);
     ~socket();
 
@@ -51,29 +80,251 @@ public:
 
     socket_protocol protocol() const noexcept;
 
+    // Returns the handle provided by the underlying socket API. Useful for integrating the socket
+    // with other APIs - the socket retains ownership of the handle.
+    handle_t native_handle() const noexcept;
+
     // Binds the socket to the provided address.
     error bind(socket_address address) const noexcept;
 
     // If the socket is bound, returns the address, or an error otherwise.
     expected<socket_address, error> address() const noexcept;
 
+    // Returns the CPU whose network stack processed the most recently received packet
+    // (SO_INCOMING_CPU), or -1 if nothing was received yet. Linux only.
+    expected<int, error> incoming_cpu() const noexcept;
+
+    // Marks the socket as serving the provided CPU (SO_INCOMING_CPU). Among sockets sharing a port
+    // with socket_flags::reuse_port, the kernel prefers the one serving the CPU which processed the
+    // packet. Linux only.
+    error set_incoming_cpu(int cpu) const noexcept;
+
+    // Sets the size of the receive buffer, which holds packets until they are received. Bursts
+    // larger than the buffer are dropped. Where the process is privileged enough, the system-wide
+    // limit on buffer sizes is bypassed (SO_RCVBUFFORCE), otherwise the size is capped by it.
+    error set_recv_buffer_size(size_t size) const noexcept;
+
+    // Sets the size of the send buffer, which holds packets until the device transmits them. Where
+    // the process is privileged enough, the system-wide limit on buffer sizes is bypassed
+    // (SO_SNDBUFFORCE), otherwise the size is capped by it.
+    error set_send_buffer_size(size_t size) const noexcept;
+
+    // Returns the size of the receive buffer. Linux doubles the requested size, to account for
+    // its bookkeeping overhead.
+    expected<size_t, error> recv_buffer_size() const noexcept;
+
+    // Returns the size of the send buffer. Linux doubles the requested size, to account for its
+    // bookkeeping overhead.
+    expected<size_t, error> send_buffer_size() const noexcept;
+
+    // Returns how much of the socket buffers is currently occupied. Linux only.
+    expected<buffer_occupancy, error> occupancy() const noexcept;
+
+    // Lets receives poll the device for packets for up to timeout (SO_BUSY_POLL), rather than wait
+    // for an interrupt, which trades CPU for latency. If prefer is set, the device keeps its
+    // interrupts suppressed while the socket is busy polling (SO_PREFER_BUSY_POLL). A non-zero
+    // budget caps the number of packets processed per poll (SO_BUSY_POLL_BUDGET). Raising these
+    // above system defaults requires privileges. Linux only.
+    error set_busy_poll(std::chrono::microseconds timeout,
+                        bool                      prefer = false,
+                        uint16_t                  budget = 0) const noexcept;
+
+    // Returns the number of packets the kernel dropped on the socket so far, e.g. because its
+    // receive buffer was full. Unlike packet::dropped, it doesn't require receiving anything, nor
+    // socket_flags::drop_counter. Linux only.
+    expected<uint32_t, error> dropped_packets() const noexcept;
+
+    // Caps the rate at which the kernel transmits the datagrams sent by the socket, in bytes per
+    // second, spreading bursts out evenly. Enforced by the fq queueing discipline. Linux only.
+    error set_pacing_rate(uint64_t bytes_per_second) const noexcept;
+
+    // Marks the datagrams sent by the socket with the provided ECN codepoint, keeping the DSCP of
+    // the traffic class. Congestion-aware senders mark their datagrams with ecn_codepoint::ect0,
+    // and watch for ecn_codepoint::ce in the feedback of their peers. Not available on Windows.
+    error set_ecn(ecn_codepoint codepoint) const noexcept;
+
+    // Joins a multicast group on the interface with the provided index, or on an interface picked
+    // by the system if the index is zero. Packets sent to the group are then received by the
+    // socket, if it's bound to the group's port.
+    error join_group(socket_address group, uint32_t interface_index = 0) const noexcept;
+
+    // Leaves a multicast group previously joined with join_group.
+    error leave_group(socket_address group, uint32_t interface_index = 0) const noexcept;
+
+    // Same as join_group, but only packets from the provided source are received (source-specific
+    // multicast).
+    error join_source_group(socket_address group,
+                            socket_address source,
+                            uint32_t       interface_index = 0) const noexcept;
+
+    // Leaves a multicast group previously joined with join_source_group.
+    error leave_source_group(socket_address group,
+                             socket_address source,
+                             uint32_t       interface_index = 0) const noexcept;
+
+    // Sets the interface multicast packets are sent through. Zero lets the system pick one.
+    error set_multicast_interface(uint32_t interface_index) const noexcept;
+
+    // Sets whether multicast packets sent by the socket are also delivered to group members on
+    // the local host. Enabled by default.
+    error set_multicast_loop(bool enable) const noexcept;
+
+    // Sets how many routers multicast packets sent by the socket may cross. Defaults to 1, which
+    // keeps them within the local network.
+    error set_multicast_ttl(uint8_t ttl) const noexcept;
+
+    // Associates the socket with a single peer. Sends without an address go to the peer, using a
+    // route the kernel looks up once, and packets from other addresses are no longer received.
+    // Errors reported by the peer's host (e.g. port unreachable) surface on subsequent operations.
+    error connect(socket_address address) noexcept;
+
+    // Attempt to send the data from a user-provided buffer to the peer the socket is connected to.
+    // Skips the per-call address handling of the addressed overload.
+    error send(std::span<const char> buffer) const noexcept;
+
     // Attempt to send the data from a user-provided buffer. Returns an error in case of failure -
     // for example, it might return error_code::socket_would_block under some circumstances.
     error send(socket_address address, std::span<const char> buffer) const noexcept;
 
+    // Same as the addressed send, but the datagram is gathered from several buffers, in order -
+    // e.g. a header, a body and a trailer - without copying them into one. At most
+    // max_buffer_count buffers can be provided.
+    error send(socket_address                         address,
+               std::span<const std::span<const char>> buffers) const noexcept;
+
+    // Same as the addressed send, but the packet is sent from the provided local address, e.g.
+    // packet::destination of the packet being replied to. A non-zero interface index also picks
+    // the interface the packet leaves through. The port of the source address is ignored. Linux
+    // only.
+    error send(socket_address        address,
+               std::span<const char> buffer,
+               socket_address        source,
+               uint32_t              interface_index = 0) const noexcept;
+
+    // Same as the addressed send, but the packet doesn't leave the host before the provided time.
+    // Spreading the departures of a burst smooths it out without sleeping between sends. Requires
+    // socket_flags::txtime. Linux only.
+    error send_at(socket_address                        address,
+                  std::span<const char>                 buffer,
+                  std::chrono::steady_clock::time_point departure) const noexcept;
+
+    // Same as the addressed send, but the destination is already in native form, so no address
+    // conversion takes place. The endpoint must have been created for the socket's protocol.
+    error send(const socket_endpoint& endpoint, std::span<const char> buffer) const noexcept;
+
+    // Attempt to send multiple packets at once, using a single system call per max_batch_size
+    // packets where the platform allows it. Returns the number of packets sent, which may be lower
+    // than packets.size() if the socket stopped accepting data midway - in that case, the remainder
+    // can be resent later using packets.subspan(count). If no packets could be sent, returns an
+    // error, e.g. error_code::socket_would_block.
+    expected<size_t, error> send_batch(std::span<const outgoing_packet> packets) const noexcept;
+
+    // Attempt to send the data from a user-provided buffer as a series of datagrams, each
+    // segment_size bytes long (the last one may be shorter). Where available, segmentation is
+    // offloaded to the kernel (UDP_SEGMENT), so that per-packet costs are paid once for many
+    // datagrams; otherwise, segments are sent one by one. Returns the number of bytes sent, which
+    // may be lower than buffer.size() if the socket stopped accepting data midway. If nothing could
+    // be sent, returns an error, e.g. error_code::socket_would_block.
+    expected<size_t, error> send_segmented(socket_address        address,
+                                           std::span<const char> buffer,
+                                           size_t                segment_size) const noexcept;
+
+    // Attempt to send the data from a user-provided buffer without copying it into the kernel
+    // (MSG_ZEROCOPY), which pays off for payloads of several kilobytes and more. Requires
+    // socket_flags::zerocopy. Returns the ID of the send - the buffer must not be modified until a
+    // completion covering the ID is returned from poll_zerocopy. IDs are assigned sequentially,
+    // starting from zero, so sends on a zero-copy socket shouldn't be issued concurrently.
+    expected<uint32_t, error> send_zerocopy(socket_address        address,
+                                            std::span<const char> buffer) const noexcept;
+
+    // Check if the kernel has finished with any zero-copy sends, and returns the range of their
+    // IDs. A single completion often covers many sends. If there are no completions waiting, it
+    // returns error_code::socket_would_block. Linux only.
+    expected<zerocopy_completion, error> poll_zerocopy() const noexcept;
+
+    // Check if the kernel has timestamped any sent datagrams, and returns the next timestamp.
+    // Requires socket_flags::tx_timestamps. Each datagram is timestamped twice - once when it
+    // enters the device queue, and once when it is handed to the driver - so the difference
+    // between the time of the send call and the two timestamps splits send latency into the time
+    // spent in the kernel stack, in the queueing discipline and in the driver. If there are no
+    // timestamps waiting, it returns error_code::socket_would_block. Linux only.
+    //
+    // Both zero-copy completions and timestamps are read from the socket's error queue, and each
+    // poll function discards the reports of the other, so a socket shouldn't use both.
+    expected<tx_timestamp, error> poll_tx_timestamp() const noexcept;
+
     // Check if there are any packets waiting and process them, copying their data into the
     // user-provided buffer. Returns a wadjet::packet structure which provides a view into the
     // buffer, along with the address which the packet came from. In case of failure, returns an
-    // error. If there are no packets waiting, it returns error_code::socket_would_block.
+    // error. If there are no packets waiting, it returns error_code::socket_would_block. If the
+    // socket is connected, the source address isn't read back at all - the peer is reported. If
+    // the packet doesn't fit into the buffer, it's cut short - see packet::truncated.
+    //
+    // If the socket was created with socket_flags::udp_gro, a single packet may contain multiple
+    // datagrams - see packet::segments. The buffer should be large enough to hold the largest
+    // possible coalesced payload (64 KiB), otherwise datagrams are truncated.
     expected<packet, error> recv(std::span<char> buffer) const noexcept;
 
+    // Same as recv, but the datagram is scattered over several buffers, in order - e.g. a
+    // fixed-size header lands in one, and the body in its final storage. At most max_buffer_count
+    // buffers can be provided. Only the first buffer is reachable through the returned packet - its
+    // payload, and so its segments, view the filled part of the first buffer. The rest of the
+    // datagram continues into the following buffers, which callers have to walk themselves: the
+    // number of bytes received into all of them is the smaller of packet::full_size and their
+    // combined size. The datagram is only truncated if it doesn't fit into all of them combined.
+    expected<packet, error> recv(std::span<const std::span<char>> buffers) const noexcept;
+
+    // Returns the size of the next packet waiting to be received, without receiving it, so that a
+    // buffer can be sized to fit it. If there are no packets waiting, it returns
+    // error_code::socket_would_block. On platforms other than Linux, an empty packet can't be
+    // told apart from no packet at all. On Windows and the BSDs, it returns the size of all the
+    // packets waiting, which only bounds the size of the next one from above.
+    expected<size_t, error> peek_size() const noexcept;
+
+    // Same as recv, but the source of the packet is stored into the user-provided endpoint in
+    // native form, rather than converted into an address - packet::address isn't filled in.
+    expected<packet, error> recv(std::span<char> buffer, socket_endpoint& source) const noexcept;
+
+    // Same as recv, but if there are no packets waiting, sleeps until one arrives or until the
+    // timeout expires, rather than returning right away. A negative timeout waits indefinitely. If
+    // the timeout expires, it returns error_code::socket_would_block.
+    expected<packet, error> recv_for(std::span<char>           buffer,
+                                     std::chrono::milliseconds timeout) const noexcept;
+
+    // Same as recv_for, but spins on recv for a while before going to sleep, which avoids the
+    // wake-up latency and jitter of sleeping when packets arrive in quick succession. How long it
+    // spins adapts to the traffic - see spin_wait. Combine with set_busy_poll to also skip device
+    // interrupts while spinning.
+    expected<packet, error> recv_adaptive(std::span<char>           buffer,
+                                          spin_wait&                wait,
+                                          std::chrono::milliseconds timeout) const noexcept;
+
+    // Receive multiple packets at once, using a single system call where the platform allows it.
+    // Each received packet is copied into its own user-provided buffer, and described by an entry
+    // in the user-provided packet storage. At most min(buffers.size(), packets.size(),
+    // max_batch_size) packets are received. Returns a view into the packet storage, containing only
+    // the received packets. If there are no packets waiting, it returns
+    // error_code::socket_would_block.
+    expected<std::span<packet>, error> recv_batch(std::span<const std::span<char>> buffers,
+                                                  std::span<packet> packets) const noexcept;
+
 private:
+    // Sets an option concerning multicast packets, for the protocols the socket sends with.
+    error set_multicast_option(int ipv4_name, int ipv6_name, int value) const noexcept;
+
     socket_protocol protocol_m;
 
-    // Handle provided by underlying socket API.
-    using handle_t = int;
+    // Flags the socket was created with.
+    socket_flags flags_m;
 
     handle_t handle_m;
+
+    // Peer the socket is connected to, if any.
+    socket_address peer_m;
+    bool           connected_m;
+
+    // ID the kernel assigns to the next zero-copy send.
+    mutable uint32_t zerocopy_next_m;
 };
 
 } // namespace wadjet
\ No newline at end of file
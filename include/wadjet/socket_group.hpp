@@ -0,0 +1,132 @@
+#pragma once
+
+#include <wadjet/detail/linking.hpp>
+#include <wadjet/errors.hpp>
+#include <wadjet/expected.hpp>
+#include <wadjet/network.hpp>
+#include <wadjet/socket.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace wadjet {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Socket group statistics.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct WADJET_DLL socket_group_stats
+{
+    uint64_t packets_received = 0;
+    uint64_t bytes_received   = 0;
+    uint64_t packets_sent     = 0;
+    uint64_t bytes_sent       = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Socket group.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// A group of sockets bound to the same address with SO_REUSEPORT, meant to be used with one member
+// per worker thread. On Linux, the kernel distributes incoming flows between the members, so
+// receiving scales with the number of threads. Elsewhere, SO_REUSEPORT doesn't balance datagrams -
+// on macOS and the BSDs, a single member receives all of them. Not available on Windows.
+class WADJET_DLL socket_group
+{
+public:
+    // A socket belonging to the group. Operations performed through the member are accounted in
+    // its statistics.
+    class WADJET_DLL member
+    {
+    public:
+        member(socket_protocol protocol, socket_flags flags, size_t index);
+
+        // Disable copy and move - members are referred to by the worker threads that own them.
+        member(const member& other) = delete;
+        member& operator=(const member& other) = delete;
+
+        // Index of the member within the group.
+        size_t index() const noexcept;
+
+        // The underlying socket, for operations not covered by the member itself.
+        const wadjet::socket& socket() const noexcept;
+
+        // Same as socket::send, but accounted in the member statistics.
+        error send(socket_address address, std::span<const char> buffer) noexcept;
+
+        // Same as socket::recv, but accounted in the member statistics.
+        expected<packet, error> recv(std::span<char> buffer) noexcept;
+
+        // Same as socket::recv_for, but accounted in the member statistics.
+        expected<packet, error> recv_for(std::span<char>           buffer,
+                                         std::chrono::milliseconds timeout) noexcept;
+
+        // Same as socket::recv_batch, but accounted in the member statistics.
+        expected<std::span<packet>, error> recv_batch(std::span<const std::span<char>> buffers,
+                                                      std::span<packet> packets) noexcept;
+
+        // Returns a snapshot of the member statistics. Safe to call from any thread.
+        socket_group_stats stats() const noexcept;
+
+    private:
+        void account_received(std::span<const packet> packets) noexcept;
+
+        wadjet::socket socket_m;
+        size_t         index_m;
+
+        std::atomic<uint64_t> packets_received_m;
+        std::atomic<uint64_t> bytes_received_m;
+        std::atomic<uint64_t> packets_sent_m;
+        std::atomic<uint64_t> bytes_sent_m;
+    };
+
+    // Creates a group of size sockets, all bound to the provided address. If the port is zero, the
+    // first member is bound to an ephemeral port, which the rest of the members then share. Flags
+    // are applied to every member, along with socket_flags::reuse_port. Throws on failure.
+    socket_group(socket_protocol protocol,
+                 socket_flags    flags,
+                 socket_address  address,
+                 size_t          size);
+
+    // Disable copy - members are referred to by the worker threads that own them.
+    socket_group(const socket_group& other) = delete;
+    socket_group& operator=(const socket_group& other) = delete;
+
+    socket_group(socket_group&& other) noexcept            = default;
+    socket_group& operator=(socket_group&& other) noexcept = default;
+
+    // Number of members in the group.
+    size_t size() const noexcept;
+
+    // Address all members are bound to.
+    socket_address address() const noexcept;
+
+    // Returns the member with the provided index. Each worker thread should use its own member.
+    member&       operator[](size_t index) noexcept;
+    const member& operator[](size_t index) const noexcept;
+
+    // Steers each packet to the member with the index matching the CPU which processed it, modulo
+    // the group size, rather than by flow hash. With one member per CPU, and each worker thread
+    // pinned to its member's CPU (see pin_current_thread), packets are processed on the same core
+    // from the network stack to the application, which keeps their cache lines local. Linux only.
+    error steer_by_cpu() const noexcept;
+
+    // Pins the calling thread to the provided CPU, and returns the index of the member which
+    // receives packets processed on that CPU once steer_by_cpu is in effect. Linux only.
+    expected<size_t, error> pin_current_thread(int cpu) const noexcept;
+
+    // Returns the sum of all member statistics.
+    socket_group_stats stats() const noexcept;
+
+private:
+    socket_address address_m;
+
+    // Members are kept behind pointers, so references to them survive a move of the group.
+    std::vector<std::unique_ptr<member>> members_m;
+};
+
+} // namespace wadjet
@@ -19,6 +19,18 @@ inline const std::map<error_code, zstring_view> error_descriptions = {
     {error_code::socket_recv_error, "failed to receive data"},
     {error_code::socket_would_block, "no data received at the time"},
     {error_code::socket_address_conversion_fail, "failed to convert string to address"},
+    {error_code::socket_option_unavailable, "failed to enable socket option"},
+    {error_code::io_uring_setup_fail, "failed to set up io_uring instance"},
+    {error_code::io_uring_registration_fail, "failed to register resources with io_uring"},
+    {error_code::io_uring_submission_queue_full, "io_uring submission queue is full"},
+    {error_code::io_uring_submit_fail, "failed to submit operations to io_uring"},
+    {error_code::poller_creation_fail, "failed to create poller"},
+    {error_code::poller_registration_fail, "failed to register socket with poller"},
+    {error_code::poller_wait_fail, "failed to wait for socket events"},
+    {error_code::socket_option_query_fail, "failed to query socket option"},
+    {error_code::thread_affinity_fail, "failed to set thread affinity"},
+    {error_code::socket_connect_error, "failed to connect socket"},
+    {error_code::multicast_membership_fail, "failed to change multicast group membership"},
 };
 }
 
@@ -0,0 +1,713 @@
+#include <wadjet/io_uring.hpp>
+
+#include <wadjet/detail/native_address.hpp>
+#include <wadjet/detail/posix.hpp>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+namespace wadjet {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Kernel interface.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+int io_uring_setup(unsigned int entries, ::io_uring_params* params) noexcept
+{
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int          ring_fd,
+                   unsigned int to_submit,
+                   unsigned int min_complete,
+                   unsigned int flags) noexcept
+{
+    return static_cast<int>(
+        ::syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int io_uring_register(int          ring_fd,
+                      unsigned int opcode,
+                      const void*  arg,
+                      unsigned int arg_count) noexcept
+{
+    return static_cast<int>(::syscall(__NR_io_uring_register, ring_fd, opcode, arg, arg_count));
+}
+
+// Whether the kernel supports the provided operation.
+bool supports_operation(int ring_fd, uint8_t opcode) noexcept
+{
+    constexpr size_t max_operations = 256;
+
+    std::vector<char> storage(sizeof(::io_uring_probe)
+                              + max_operations * sizeof(::io_uring_probe_op));
+    ::io_uring_probe* probe = reinterpret_cast<::io_uring_probe*>(storage.data());
+
+    if(io_uring_register(ring_fd, IORING_REGISTER_PROBE, probe, max_operations) < 0)
+        return false;
+
+    return opcode < probe->ops_len && (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED);
+}
+
+// Ring indices are shared with the kernel, so they must be accessed atomically.
+unsigned int load_acquire(unsigned int* value) noexcept
+{
+    return std::atomic_ref<unsigned int>{*value}.load(std::memory_order_acquire);
+}
+
+void store_release(unsigned int* value, unsigned int new_value) noexcept
+{
+    std::atomic_ref<unsigned int>{*value}.store(new_value, std::memory_order_release);
+}
+
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Ring state.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct io_uring_engine::ring
+{
+    // Everything the kernel needs to perform an operation, which must stay put until it completes.
+    struct operation
+    {
+        io_operation           type;
+        uint64_t               user_data;
+        size_t                 socket_index;
+        size_t                 buffer_index;
+        socket_protocol        protocol;
+        bool                   in_flight = false;
+        ::msghdr               message;
+        ::iovec                vector;
+        detail::native_address address;
+
+        // Whether the send is performed straight from the registered buffer, and its outcome, kept
+        // until the kernel releases the buffer.
+        bool zero_copy       = false;
+        int  deferred_result = 0;
+    };
+
+    ring() = default;
+    ~ring();
+
+    // Returns an unused operation, or nullptr if too many operations are in flight.
+    operation* acquire_operation() noexcept;
+
+    // Queues the operation into the submission queue, returning the submission entry for any
+    // further adjustments.
+    ::io_uring_sqe& push(uint8_t opcode, const operation& operation) noexcept;
+
+    int fd = -1;
+
+    // Memory shared with the kernel.
+    void*           sq_map      = MAP_FAILED;
+    size_t          sq_map_size = 0;
+    void*           cq_map      = MAP_FAILED;
+    size_t          cq_map_size = 0;
+    ::io_uring_sqe* sqes        = (::io_uring_sqe*)MAP_FAILED;
+    size_t          sqes_size   = 0;
+
+    unsigned int* sq_head;
+    unsigned int* sq_tail;
+    unsigned int* sq_flags;
+    unsigned int* sq_array;
+    unsigned int  sq_mask;
+
+    unsigned int*   cq_head;
+    unsigned int*   cq_tail;
+    ::io_uring_cqe* cqes;
+    unsigned int    cq_mask;
+
+    // Number of operations queued since the last submission.
+    unsigned int pending = 0;
+
+    std::vector<operation> operations;
+    std::vector<uint32_t>  free_operations;
+
+    // Protocols of the registered sockets, or an empty optional if the slot is unused.
+    std::vector<std::optional<socket_protocol>> sockets;
+
+    std::vector<std::span<char>> buffers;
+
+    // Sends of at least this many bytes are performed straight from the registered buffers
+    // (IORING_OP_SEND_ZC), rather than through sendmsg, which copies them.
+    size_t zero_copy_threshold = io_uring_engine::no_zero_copy;
+
+    // Ring through which buffer pool buffers are provided to the kernel.
+    ::io_uring_buf_ring* buffer_ring      = (::io_uring_buf_ring*)MAP_FAILED;
+    size_t               buffer_ring_size = 0;
+    uint16_t             buffer_ring_mask = 0;
+
+    std::vector<char> buffer_pool;
+    size_t            buffer_pool_buffer_size = 0;
+};
+
+io_uring_engine::ring::~ring()
+{
+    if(buffer_ring != MAP_FAILED)
+        (void)::munmap(buffer_ring, buffer_ring_size);
+    if(sqes != MAP_FAILED)
+        (void)::munmap(sqes, sqes_size);
+    if(cq_map != MAP_FAILED && cq_map != sq_map)
+        (void)::munmap(cq_map, cq_map_size);
+    if(sq_map != MAP_FAILED)
+        (void)::munmap(sq_map, sq_map_size);
+    if(fd >= 0)
+        (void)::close(fd);
+}
+
+io_uring_engine::ring::operation* io_uring_engine::ring::acquire_operation() noexcept
+{
+    if(free_operations.empty())
+        return nullptr;
+
+    operation* result = &operations[free_operations.back()];
+    free_operations.pop_back();
+
+    result->in_flight = true;
+    return result;
+}
+
+::io_uring_sqe& io_uring_engine::ring::push(uint8_t opcode, const operation& operation) noexcept
+{
+    const unsigned int tail  = *sq_tail;
+    const unsigned int index = tail & sq_mask;
+
+    ::io_uring_sqe& sqe = sqes[index];
+    sqe                 = {};
+    sqe.opcode          = opcode;
+    sqe.flags           = IOSQE_FIXED_FILE;
+    sqe.fd              = static_cast<int>(operation.socket_index);
+    sqe.addr            = reinterpret_cast<uint64_t>(&operation.message);
+    sqe.len             = 1;
+    sqe.user_data       = static_cast<uint64_t>(&operation - operations.data());
+
+    sq_array[index] = index;
+    store_release(sq_tail, tail + 1);
+
+    ++pending;
+    return sqe;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Engine implementation.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+io_uring_engine::io_uring_engine(unsigned int                     queue_size,
+                                 size_t                           max_sockets,
+                                 std::span<const std::span<char>> buffers) :
+    ring_m(std::make_unique<ring>())
+{
+    ::io_uring_params params = {};
+
+    ring_m->fd = io_uring_setup(queue_size, &params);
+    if(ring_m->fd < 0)
+        throw exception{error_code::io_uring_setup_fail, errno};
+
+    ring_m->sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    ring_m->cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(::io_uring_cqe);
+
+    // Newer kernels map both rings with a single mmap.
+    const bool single_map = params.features & IORING_FEAT_SINGLE_MMAP;
+    if(single_map)
+        ring_m->sq_map_size = ring_m->cq_map_size =
+            std::max(ring_m->sq_map_size, ring_m->cq_map_size);
+
+    ring_m->sq_map = ::mmap(nullptr,
+                            ring_m->sq_map_size,
+                            PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE,
+                            ring_m->fd,
+                            IORING_OFF_SQ_RING);
+    if(ring_m->sq_map == MAP_FAILED)
+        throw exception{error_code::io_uring_setup_fail, errno};
+
+    if(single_map)
+    {
+        ring_m->cq_map = ring_m->sq_map;
+    }
+    else
+    {
+        ring_m->cq_map = ::mmap(nullptr,
+                                ring_m->cq_map_size,
+                                PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_POPULATE,
+                                ring_m->fd,
+                                IORING_OFF_CQ_RING);
+        if(ring_m->cq_map == MAP_FAILED)
+            throw exception{error_code::io_uring_setup_fail, errno};
+    }
+
+    ring_m->sqes_size = params.sq_entries * sizeof(::io_uring_sqe);
+    ring_m->sqes      = (::io_uring_sqe*)::mmap(nullptr,
+                                           ring_m->sqes_size,
+                                           PROT_READ | PROT_WRITE,
+                                           MAP_SHARED | MAP_POPULATE,
+                                           ring_m->fd,
+                                           IORING_OFF_SQES);
+    if(ring_m->sqes == MAP_FAILED)
+        throw exception{error_code::io_uring_setup_fail, errno};
+
+    char* sq = static_cast<char*>(ring_m->sq_map);
+    char* cq = static_cast<char*>(ring_m->cq_map);
+
+    ring_m->sq_head  = (unsigned int*)(sq + params.sq_off.head);
+    ring_m->sq_tail  = (unsigned int*)(sq + params.sq_off.tail);
+    ring_m->sq_flags = (unsigned int*)(sq + params.sq_off.flags);
+    ring_m->sq_array = (unsigned int*)(sq + params.sq_off.array);
+    ring_m->sq_mask  = *(unsigned int*)(sq + params.sq_off.ring_mask);
+
+    ring_m->cq_head = (unsigned int*)(cq + params.cq_off.head);
+    ring_m->cq_tail = (unsigned int*)(cq + params.cq_off.tail);
+    ring_m->cqes    = (::io_uring_cqe*)(cq + params.cq_off.cqes);
+    ring_m->cq_mask = *(unsigned int*)(cq + params.cq_off.ring_mask);
+
+    // Limiting the number of operations in flight to the submission queue size keeps single-shot
+    // completions within the completion queue, which is at least as large. Multishot receives
+    // aren't bounded that way, so poll_completion flushes any completions which overflowed.
+    ring_m->operations.resize(params.sq_entries);
+    ring_m->free_operations.reserve(params.sq_entries);
+    for(uint32_t i = params.sq_entries; i > 0; --i)
+        ring_m->free_operations.push_back(i - 1);
+
+    // Register a sparse file table, filled in as sockets get registered.
+    if(max_sockets > 0)
+    {
+        const std::vector<int> files(max_sockets, -1);
+        if(io_uring_register(ring_m->fd, IORING_REGISTER_FILES, files.data(), files.size()) < 0)
+            throw exception{error_code::io_uring_registration_fail, errno};
+
+        ring_m->sockets.resize(max_sockets);
+    }
+
+    // Registered buffers are pinned by the kernel once, rather than on every operation, which lets
+    // zero-copy sends transmit straight from them. Other operations go through sendmsg and
+    // recvmsg, since fixed-buffer receives don't report the source.
+    if(!buffers.empty())
+    {
+        std::vector<::iovec> vectors(buffers.size());
+        for(size_t i = 0; i < buffers.size(); ++i)
+        {
+            vectors[i].iov_base = buffers[i].data();
+            vectors[i].iov_len  = buffers[i].size();
+        }
+
+        if(io_uring_register(ring_m->fd, IORING_REGISTER_BUFFERS, vectors.data(), vectors.size())
+           < 0)
+            throw exception{error_code::io_uring_registration_fail, errno};
+
+        ring_m->buffers.assign(buffers.begin(), buffers.end());
+    }
+}
+
+io_uring_engine::~io_uring_engine() = default;
+
+io_uring_engine::io_uring_engine(io_uring_engine&& other) noexcept = default;
+
+io_uring_engine& io_uring_engine::operator=(io_uring_engine&& other) noexcept = default;
+
+expected<size_t, error> io_uring_engine::register_socket(const socket& socket) noexcept
+{
+    auto& sockets = ring_m->sockets;
+
+    const auto slot = std::find(sockets.begin(), sockets.end(), std::nullopt);
+    if(slot == sockets.end())
+        return make_unexpected<error>(error_code::io_uring_registration_fail, ENOSPC);
+
+    size_t    socket_index = static_cast<size_t>(slot - sockets.begin());
+    const int handle       = socket.native_handle();
+
+    ::io_uring_files_update update = {};
+    update.offset                  = static_cast<uint32_t>(socket_index);
+    update.fds                     = reinterpret_cast<uint64_t>(&handle);
+
+    if(io_uring_register(ring_m->fd, IORING_REGISTER_FILES_UPDATE, &update, 1) < 0)
+        return make_unexpected<error>(error_code::io_uring_registration_fail, errno);
+
+    *slot = socket.protocol();
+    return socket_index;
+}
+
+error io_uring_engine::unregister_socket(size_t socket_index) noexcept
+{
+    assert(socket_index < ring_m->sockets.size());
+
+    const int handle = -1;
+
+    ::io_uring_files_update update = {};
+    update.offset                  = static_cast<uint32_t>(socket_index);
+    update.fds                     = reinterpret_cast<uint64_t>(&handle);
+
+    if(io_uring_register(ring_m->fd, IORING_REGISTER_FILES_UPDATE, &update, 1) < 0)
+        return error{error_code::io_uring_registration_fail, errno};
+
+    ring_m->sockets[socket_index] = std::nullopt;
+    return error::success();
+}
+
+std::span<char> io_uring_engine::buffer(size_t buffer_index) const noexcept
+{
+    assert(buffer_index < ring_m->buffers.size());
+    return ring_m->buffers[buffer_index];
+}
+
+error io_uring_engine::set_zero_copy_threshold(size_t min_size) noexcept
+{
+    if(min_size != no_zero_copy && !supports_operation(ring_m->fd, IORING_OP_SEND_ZC))
+        return error{error_code::io_uring_setup_fail, EOPNOTSUPP};
+
+    ring_m->zero_copy_threshold = min_size;
+    return error::success();
+}
+
+error io_uring_engine::prepare_send(size_t         socket_index,
+                                    socket_address destination,
+                                    size_t         buffer_index,
+                                    size_t         size,
+                                    uint64_t       user_data) noexcept
+{
+    assert(socket_index < ring_m->sockets.size() && ring_m->sockets[socket_index]);
+    assert(buffer_index < ring_m->buffers.size() && size <= ring_m->buffers[buffer_index].size());
+
+    ring::operation* operation = ring_m->acquire_operation();
+    if(operation == nullptr)
+        return error{error_code::io_uring_submission_queue_full, EBUSY};
+
+    operation->type         = io_operation::send;
+    operation->user_data    = user_data;
+    operation->socket_index = socket_index;
+    operation->buffer_index = buffer_index;
+    operation->protocol     = *ring_m->sockets[socket_index];
+
+    const socklen_t address_length =
+        detail::to_native_address(operation->protocol, destination, operation->address);
+
+    operation->zero_copy       = size >= ring_m->zero_copy_threshold;
+    operation->deferred_result = 0;
+
+    if(operation->zero_copy)
+    {
+        ::io_uring_sqe& sqe = ring_m->push(IORING_OP_SEND_ZC, *operation);
+        sqe.addr            = reinterpret_cast<uint64_t>(ring_m->buffers[buffer_index].data());
+        sqe.len             = static_cast<uint32_t>(size);
+        sqe.ioprio          = IORING_RECVSEND_FIXED_BUF;
+        sqe.buf_index       = static_cast<uint16_t>(buffer_index);
+        sqe.addr2           = reinterpret_cast<uint64_t>(&operation->address);
+        sqe.addr_len        = static_cast<uint16_t>(address_length);
+
+        return error::success();
+    }
+
+    operation->vector.iov_base = ring_m->buffers[buffer_index].data();
+    operation->vector.iov_len  = size;
+
+    operation->message             = {};
+    operation->message.msg_name    = &operation->address;
+    operation->message.msg_namelen = address_length;
+    operation->message.msg_iov     = &operation->vector;
+    operation->message.msg_iovlen  = 1;
+
+    ring_m->push(IORING_OP_SENDMSG, *operation);
+    return error::success();
+}
+
+error io_uring_engine::prepare_recv(size_t   socket_index,
+                                    size_t   buffer_index,
+                                    uint64_t user_data) noexcept
+{
+    assert(socket_index < ring_m->sockets.size() && ring_m->sockets[socket_index]);
+    assert(buffer_index < ring_m->buffers.size());
+
+    ring::operation* operation = ring_m->acquire_operation();
+    if(operation == nullptr)
+        return error{error_code::io_uring_submission_queue_full, EBUSY};
+
+    operation->type         = io_operation::recv;
+    operation->user_data    = user_data;
+    operation->socket_index = socket_index;
+    operation->buffer_index = buffer_index;
+    operation->protocol     = *ring_m->sockets[socket_index];
+
+    operation->vector.iov_base = ring_m->buffers[buffer_index].data();
+    operation->vector.iov_len  = ring_m->buffers[buffer_index].size();
+
+    operation->message             = {};
+    operation->message.msg_name    = &operation->address;
+    operation->message.msg_namelen = detail::native_address_length(operation->protocol);
+    operation->message.msg_iov     = &operation->vector;
+    operation->message.msg_iovlen  = 1;
+
+    ring_m->push(IORING_OP_RECVMSG, *operation);
+    return error::success();
+}
+
+error io_uring_engine::create_buffer_pool(uint16_t buffer_count, size_t buffer_size) noexcept
+{
+    assert(buffer_count > 0 && (buffer_count & (buffer_count - 1)) == 0 && buffer_count <= 32768);
+    assert(ring_m->buffer_ring == MAP_FAILED);
+
+    // The ring must be page-aligned, which mmap guarantees.
+    ring_m->buffer_ring_size = buffer_count * sizeof(::io_uring_buf);
+    ring_m->buffer_ring      = (::io_uring_buf_ring*)::mmap(nullptr,
+                                                       ring_m->buffer_ring_size,
+                                                       PROT_READ | PROT_WRITE,
+                                                       MAP_PRIVATE | MAP_ANONYMOUS,
+                                                       -1,
+                                                       0);
+    if(ring_m->buffer_ring == MAP_FAILED)
+        return error{error_code::io_uring_registration_fail, errno};
+
+    ::io_uring_buf_reg registration = {};
+    registration.ring_addr          = reinterpret_cast<uint64_t>(ring_m->buffer_ring);
+    registration.ring_entries       = buffer_count;
+    registration.bgid               = 0;
+
+    if(io_uring_register(ring_m->fd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0)
+    {
+        const int api_error = errno;
+
+        (void)::munmap(ring_m->buffer_ring, ring_m->buffer_ring_size);
+        ring_m->buffer_ring = (::io_uring_buf_ring*)MAP_FAILED;
+
+        return error{error_code::io_uring_registration_fail, api_error};
+    }
+
+    ring_m->buffer_ring_mask        = buffer_count - 1;
+    ring_m->buffer_pool_buffer_size = buffer_size;
+    ring_m->buffer_pool.resize(buffer_count * buffer_size);
+
+    for(uint16_t i = 0; i < buffer_count; ++i)
+        recycle_buffer(i);
+
+    return error::success();
+}
+
+error io_uring_engine::prepare_multishot_recv(size_t socket_index, uint64_t user_data) noexcept
+{
+    assert(socket_index < ring_m->sockets.size() && ring_m->sockets[socket_index]);
+    assert(ring_m->buffer_ring != MAP_FAILED);
+
+    ring::operation* operation = ring_m->acquire_operation();
+    if(operation == nullptr)
+        return error{error_code::io_uring_submission_queue_full, EBUSY};
+
+    operation->type         = io_operation::multishot_recv;
+    operation->user_data    = user_data;
+    operation->socket_index = socket_index;
+    operation->buffer_index = io_completion::no_buffer;
+    operation->protocol     = *ring_m->sockets[socket_index];
+
+    // The message only serves as a template - the kernel lays out every received packet in a
+    // buffer pool buffer as io_uring_recvmsg_out, followed by the address and the payload.
+    operation->address             = {};
+    operation->message             = {};
+    operation->message.msg_namelen = detail::native_address_length(operation->protocol);
+
+    ::io_uring_sqe& sqe = ring_m->push(IORING_OP_RECVMSG, *operation);
+    sqe.flags           = IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT;
+    sqe.ioprio          = IORING_RECV_MULTISHOT;
+    sqe.buf_group       = 0;
+
+    return error::success();
+}
+
+error io_uring_engine::prepare_cancel(uint64_t user_data) noexcept
+{
+    auto& operations = ring_m->operations;
+
+    const auto target = std::find_if(operations.begin(), operations.end(), [&](const auto& op) {
+        return op.in_flight && op.type != io_operation::cancel && op.user_data == user_data;
+    });
+    if(target == operations.end())
+        return error{error_code::io_uring_submit_fail, ENOENT};
+
+    ring::operation* operation = ring_m->acquire_operation();
+    if(operation == nullptr)
+        return error{error_code::io_uring_submission_queue_full, EBUSY};
+
+    operation->type         = io_operation::cancel;
+    operation->user_data    = user_data;
+    operation->socket_index = target->socket_index;
+    operation->buffer_index = io_completion::no_buffer;
+    operation->protocol     = target->protocol;
+    operation->address      = {};
+
+    // Operations are identified by their index in the submission user data.
+    ::io_uring_sqe& sqe = ring_m->push(IORING_OP_ASYNC_CANCEL, *operation);
+    sqe.flags           = 0;
+    sqe.fd              = -1;
+    sqe.addr            = static_cast<uint64_t>(target - operations.begin());
+    sqe.len             = 0;
+
+    return error::success();
+}
+
+void io_uring_engine::recycle_buffer(size_t buffer_id) noexcept
+{
+    assert(ring_m->buffer_ring != MAP_FAILED);
+    assert(buffer_id <= ring_m->buffer_ring_mask);
+
+    ::io_uring_buf_ring* buffer_ring = ring_m->buffer_ring;
+
+    const uint16_t tail = buffer_ring->tail;
+
+    const size_t buffer_size = ring_m->buffer_pool_buffer_size;
+    char*        data        = &ring_m->buffer_pool[buffer_id * buffer_size];
+
+    // Entries are addressed manually, since in C++ the kernel header's flexible array member is
+    // preceded by a non-empty struct, which shifts it away from the start of the ring.
+    ::io_uring_buf* entries = reinterpret_cast<::io_uring_buf*>(buffer_ring);
+
+    ::io_uring_buf& buffer = entries[tail & ring_m->buffer_ring_mask];
+    buffer.addr            = reinterpret_cast<uint64_t>(data);
+    buffer.len             = static_cast<uint32_t>(buffer_size);
+    buffer.bid             = static_cast<uint16_t>(buffer_id);
+
+    std::atomic_ref<uint16_t>{buffer_ring->tail}.store(tail + 1, std::memory_order_release);
+}
+
+expected<size_t, error> io_uring_engine::submit(unsigned int min_completions) noexcept
+{
+    if(ring_m->pending == 0 && min_completions == 0)
+        return size_t{0};
+
+    const unsigned int flags  = min_completions > 0 ? IORING_ENTER_GETEVENTS : 0;
+    const int          result = io_uring_enter(ring_m->fd, ring_m->pending, min_completions, flags);
+    if(result < 0)
+        return make_unexpected<error>(error_code::io_uring_submit_fail, errno);
+
+    ring_m->pending -= static_cast<unsigned int>(result);
+    return static_cast<size_t>(result);
+}
+
+std::optional<io_completion> io_uring_engine::poll_completion() noexcept
+{
+    const unsigned int head = *ring_m->cq_head;
+    if(head == load_acquire(ring_m->cq_tail))
+    {
+        // Completions which didn't fit into the completion queue are kept by the kernel, until
+        // they're asked for once there's room for them again (IORING_FEAT_NODROP, Linux 5.5).
+        if(!(load_acquire(ring_m->sq_flags) & IORING_SQ_CQ_OVERFLOW))
+            return std::nullopt;
+
+        if(io_uring_enter(ring_m->fd, 0, 0, IORING_ENTER_GETEVENTS) < 0)
+            return std::nullopt;
+
+        if(head == load_acquire(ring_m->cq_tail))
+            return std::nullopt;
+    }
+
+    const ::io_uring_cqe& cqe = ring_m->cqes[head & ring_m->cq_mask];
+
+    const uint32_t   operation_index = static_cast<uint32_t>(cqe.user_data);
+    int              result          = cqe.res;
+    const uint32_t   flags           = cqe.flags;
+    ring::operation& operation       = ring_m->operations[operation_index];
+
+    // The completion entry has been consumed, so the kernel may reuse it.
+    store_release(ring_m->cq_head, head + 1);
+
+    // A zero-copy send completes twice - once it's been sent, and once the kernel no longer uses
+    // the buffer. Only the latter is reported, with the outcome of the former.
+    if(operation.type == io_operation::send && operation.zero_copy)
+    {
+        if(flags & IORING_CQE_F_MORE)
+        {
+            operation.deferred_result = result;
+            return poll_completion();
+        }
+
+        if(flags & IORING_CQE_F_NOTIF)
+            result = operation.deferred_result;
+    }
+
+    // Multishot operations stay in flight for as long as the kernel keeps them armed.
+    const bool active = flags & IORING_CQE_F_MORE;
+    if(!active)
+    {
+        operation.in_flight = false;
+        ring_m->free_operations.push_back(operation_index);
+    }
+
+    error_code code = error_code::none;
+    if(result < 0)
+    {
+        if(-result == EAGAIN)
+            code = error_code::socket_would_block;
+        else if(operation.type == io_operation::send)
+            code = error_code::socket_send_error;
+        else if(operation.type == io_operation::cancel)
+            code = error_code::io_uring_submit_fail;
+        else
+            code = error_code::socket_recv_error;
+    }
+
+    const error outcome = result < 0 ? error{code, -result} : error::success();
+
+    if(operation.type == io_operation::multishot_recv && (flags & IORING_CQE_F_BUFFER))
+    {
+        const size_t buffer_id   = flags >> IORING_CQE_BUFFER_SHIFT;
+        const size_t buffer_size = ring_m->buffer_pool_buffer_size;
+        char*        buffer      = &ring_m->buffer_pool[buffer_id * buffer_size];
+
+        ::io_uring_recvmsg_out header;
+        std::memcpy(&header, buffer, sizeof(header));
+
+        // The address and control data occupy as much space as the template message requested,
+        // regardless of how much of it was actually used.
+        const size_t name_offset    = sizeof(header);
+        const size_t payload_offset = name_offset + operation.message.msg_namelen;
+        const size_t payload_space  = buffer_size - std::min(payload_offset, buffer_size);
+        const size_t payload_size   = std::min<size_t>(header.payloadlen, payload_space);
+
+        detail::native_address address = {};
+        std::memcpy(&address,
+                    buffer + name_offset,
+                    std::min<size_t>(operation.message.msg_namelen, sizeof(address)));
+
+        // The packet may not have fit into the pool buffer, either.
+        const bool truncated = (header.flags & MSG_TRUNC) || header.payloadlen > payload_size;
+
+        return io_completion{operation.type,
+                             operation.user_data,
+                             operation.socket_index,
+                             buffer_id,
+                             active,
+                             outcome,
+                             detail::from_native_address(operation.protocol, address),
+                             std::span<char>{buffer + payload_offset, payload_size},
+                             truncated};
+    }
+
+    const size_t transferred = result >= 0 ? static_cast<size_t>(result) : 0;
+
+    std::span<char> payload;
+    if(operation.type == io_operation::send || operation.type == io_operation::recv)
+        payload = ring_m->buffers[operation.buffer_index].first(transferred);
+
+    // The kernel reports truncation through the message of the receive.
+    const bool truncated = operation.type == io_operation::recv && result >= 0
+                           && (operation.message.msg_flags & MSG_TRUNC);
+
+    return io_completion{operation.type,
+                         operation.user_data,
+                         operation.socket_index,
+                         operation.buffer_index,
+                         active,
+                         outcome,
+                         detail::from_native_address(operation.protocol, operation.address),
+                         payload,
+                         truncated};
+}
+
+} // namespace wadjet
@@ -1,11 +1,16 @@
 #include <wadjet/network.hpp>
 
+#include <wadjet/detail/native_address.hpp>
 #include <wadjet/detail/posix.hpp>
 
 #include <cstring>
 
 namespace wadjet {
 
+socket_address::socket_address() noexcept : socket_address(static_cast<uint32_t>(INADDR_ANY), 0)
+{
+}
+
 socket_address::socket_address(uint32_t address, uint16_t port) noexcept :
     port_m(htons(port)), protocol_m(socket_protocol::ipv4)
 {
@@ -30,7 +35,7 @@ socket_address::socket_address(socket_protocol protocol, zstring_view address_st
 socket_address::socket_address(socket_protocol protocol,
                                zstring_view    address_string,
                                uint16_t        port) :
-    port_m(htons(port)), protocol_m(socket_protocol::ipv6)
+    port_m(htons(port)), protocol_m(protocol)
 {
     if(protocol == socket_protocol::ipv6)
     {
@@ -162,4 +167,59 @@ std::span<const uint8_t> socket_address::ipv6() const noexcept
     return std::span{ipv6_m, ipv6_size};
 }
 
+socket_protocol socket_address::protocol() const noexcept
+{
+    return protocol_m;
+}
+
+bool socket_address::is_multicast() const noexcept
+{
+    const bool mapped =
+        ipv4_m.padding_zeroes_1 == 0 && ipv4_m.padding_zeroes_2 == 0 && ipv4_m.ffff == 0xffff;
+
+    if(mapped)
+        return (ntohl(ipv4_m.ip) >> 28) == 0xe;
+
+    return ipv6_m[0] == 0xff;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Socket endpoint implementation.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+static_assert(sizeof(detail::native_address) <= socket_endpoint::storage_size);
+
+socket_endpoint::socket_endpoint() noexcept : socket_endpoint(socket_protocol::ipv4, {})
+{
+}
+
+socket_endpoint::socket_endpoint(socket_protocol protocol, socket_address address) noexcept :
+    protocol_m(protocol)
+{
+    detail::native_address native;
+    size_m = detail::to_native_address(protocol, address, native);
+
+    std::memset(storage_m, 0, sizeof(storage_m));
+    std::memcpy(storage_m, &native, size_m);
+}
+
+socket_protocol socket_endpoint::protocol() const noexcept
+{
+    return protocol_m;
+}
+
+socket_address socket_endpoint::address() const noexcept
+{
+    detail::native_address native;
+    std::memcpy(&native, storage_m, sizeof(native));
+
+    return detail::from_native_address(protocol_m, native);
+}
+
+bool socket_endpoint::operator==(const socket_endpoint& other) const noexcept
+{
+    return protocol_m == other.protocol_m && size_m == other.size_m
+           && std::memcmp(storage_m, other.storage_m, size_m) == 0;
+}
+
 } // namespace wadjet
\ No newline at end of file
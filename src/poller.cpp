@@ -0,0 +1,152 @@
+#include <wadjet/poller.hpp>
+
+#include <wadjet/detail/posix.hpp>
+
+#include <sys/epoll.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+
+namespace wadjet {
+
+namespace {
+
+uint32_t to_native_events(poll_events events, poll_mode mode) noexcept
+{
+    uint32_t native_events = 0;
+    if(detail::enum_get(events, poll_events::readable))
+        native_events |= EPOLLIN;
+    if(detail::enum_get(events, poll_events::writable))
+        native_events |= EPOLLOUT;
+    if(mode == poll_mode::edge_triggered)
+        native_events |= EPOLLET;
+
+    return native_events;
+}
+
+poll_events from_native_events(uint32_t native_events) noexcept
+{
+    poll_events events = poll_events::none;
+    if(native_events & EPOLLIN)
+        events |= poll_events::readable;
+    if(native_events & EPOLLOUT)
+        events |= poll_events::writable;
+    if(native_events & (EPOLLERR | EPOLLHUP))
+        events |= poll_events::error;
+
+    return events;
+}
+
+} // namespace
+
+poller::poller() : handle_m(::epoll_create1(EPOLL_CLOEXEC))
+{
+    if(handle_m == detail::api_invalid_socket)
+        throw exception{error_code::poller_creation_fail, detail::get_socket_api_error()};
+}
+
+poller::~poller()
+{
+    if(handle_m != detail::api_invalid_socket)
+        (void)::close(handle_m);
+}
+
+poller::poller(poller&& other) noexcept :
+    handle_m(other.handle_m), registrations_m(std::move(other.registrations_m))
+{
+    other.handle_m = detail::api_invalid_socket;
+}
+
+poller& poller::operator=(poller&& other) noexcept
+{
+    if(handle_m != detail::api_invalid_socket)
+        (void)::close(handle_m);
+
+    handle_m        = other.handle_m;
+    other.handle_m  = detail::api_invalid_socket;
+    registrations_m = std::move(other.registrations_m);
+    return *this;
+}
+
+error poller::add(const socket& socket, poll_events events, poll_mode mode, poll_callback callback)
+{
+    const socket::handle_t handle = socket.native_handle();
+
+    ::epoll_event event = {};
+    event.events        = to_native_events(events, mode);
+    event.data.fd       = handle;
+
+    if(::epoll_ctl(handle_m, EPOLL_CTL_ADD, handle, &event) == detail::api_socket_error)
+        return error{error_code::poller_registration_fail, detail::get_socket_api_error()};
+
+    registrations_m.insert_or_assign(handle, registration{&socket, std::move(callback)});
+    return error::success();
+}
+
+error poller::modify(const socket& socket, poll_events events, poll_mode mode) noexcept
+{
+    ::epoll_event event = {};
+    event.events        = to_native_events(events, mode);
+    event.data.fd       = socket.native_handle();
+
+    if(::epoll_ctl(handle_m, EPOLL_CTL_MOD, socket.native_handle(), &event)
+       == detail::api_socket_error)
+        return error{error_code::poller_registration_fail, detail::get_socket_api_error()};
+
+    return error::success();
+}
+
+error poller::remove(const socket& socket) noexcept
+{
+    if(::epoll_ctl(handle_m, EPOLL_CTL_DEL, socket.native_handle(), nullptr)
+       == detail::api_socket_error)
+        return error{error_code::poller_registration_fail, detail::get_socket_api_error()};
+
+    registrations_m.erase(socket.native_handle());
+    return error::success();
+}
+
+expected<size_t, error> poller::wait(std::chrono::milliseconds timeout)
+{
+    const int native_timeout =
+        timeout.count() < 0 ? -1 : static_cast<int>(std::min<int64_t>(timeout.count(), INT_MAX));
+
+    ::epoll_event events[max_events];
+
+    const int count = ::epoll_wait(handle_m, events, max_events, native_timeout);
+    if(count < 0)
+    {
+        const auto api_error = detail::get_socket_api_error();
+        if(api_error == EINTR)
+            return size_t{0};
+
+        return make_unexpected<error>(error_code::poller_wait_fail, api_error);
+    }
+
+    size_t dispatched = 0;
+    for(int i = 0; i < count; ++i)
+    {
+        // Look the socket up rather than keeping a pointer in the event, so that callbacks can
+        // safely remove sockets whose events are still pending.
+        const auto it = registrations_m.find(events[i].data.fd);
+        if(it == registrations_m.end())
+            continue;
+
+        // The callback is moved out while it runs, since it might remove its own socket.
+        const socket& ready_socket = *it->second.watched;
+        poll_callback callback     = std::move(it->second.callback);
+
+        callback(ready_socket, from_native_events(events[i].events));
+        ++dispatched;
+
+        // Put the callback back, unless the socket was removed or re-added in the meantime.
+        const auto current = registrations_m.find(events[i].data.fd);
+        if(current != registrations_m.end() && !current->second.callback)
+            current->second.callback = std::move(callback);
+    }
+
+    return dispatched;
+}
+
+} // namespace wadjet
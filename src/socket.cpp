@@ -1,11 +1,374 @@
 #include <wadjet/socket.hpp>
 
+#include <wadjet/detail/native_address.hpp>
 #include <wadjet/detail/posix.hpp>
 
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <climits>
 #include <cstring>
 
 namespace wadjet {
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Internal helpers.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+using detail::from_native_address;
+using detail::native_address;
+using detail::native_address_length;
+using detail::to_native_address;
+
+// Translates the last socket API error of a send operation into a wadjet error.
+error last_send_error() noexcept
+{
+    const auto api_error = detail::get_socket_api_error();
+    if(api_error == detail::api_error_would_block)
+        return error{error_code::socket_would_block, api_error};
+
+    return error{error_code::socket_send_error, api_error};
+}
+
+// Translates the last socket API error of a receive operation into a wadjet error.
+error last_recv_error() noexcept
+{
+    const auto api_error = detail::get_socket_api_error();
+    if(api_error == detail::api_error_would_block)
+        return error{error_code::socket_would_block, api_error};
+
+    return error{error_code::socket_recv_error, api_error};
+}
+
+#ifdef __linux__
+// Flags of receive calls - they make the calls report the full size of truncated datagrams.
+constexpr int recv_flags = MSG_TRUNC;
+#else
+constexpr int recv_flags = 0;
+#endif
+
+// Describes a received datagram of the given full size, whose payload was cut to fit the buffer.
+packet received_packet(socket_address address, std::span<char> buffer, size_t size) noexcept
+{
+    packet incoming{address, buffer.first(std::min(size, buffer.size()))};
+    incoming.full_size = size;
+    incoming.truncated = size > buffer.size();
+    return incoming;
+}
+
+#ifdef __linux__
+// Size of the buffer which receives ancillary data alongside a packet.
+constexpr size_t control_buffer_size = 256;
+
+// Converts a timestamp reported by the kernel into a time point.
+std::chrono::system_clock::time_point to_time_point(const ::timespec& timestamp) noexcept
+{
+    const auto since_epoch =
+        std::chrono::seconds{timestamp.tv_sec} + std::chrono::nanoseconds{timestamp.tv_nsec};
+
+    return std::chrono::system_clock::time_point{
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(since_epoch)};
+}
+
+// Whether sockets with the given flags receive ancillary data alongside packets.
+bool receives_control_messages(socket_flags flags) noexcept
+{
+    return detail::enum_get(flags, socket_flags::udp_gro)
+           || detail::enum_get(flags, socket_flags::rx_timestamps)
+           || detail::enum_get(flags, socket_flags::drop_counter)
+           || detail::enum_get(flags, socket_flags::packet_info)
+           || detail::enum_get(flags, socket_flags::ecn);
+}
+
+// Size of the ancillary data carrying a departure time.
+constexpr size_t departure_control_size = CMSG_SPACE(sizeof(uint64_t));
+
+// Attaches a departure time to a message, using the provided control buffer.
+void set_departure(::msghdr&                             message,
+                   char*                                 control,
+                   std::chrono::steady_clock::time_point departure) noexcept
+{
+    message.msg_control    = control;
+    message.msg_controllen = departure_control_size;
+
+    // The steady clock is the monotonic clock, which is what SO_TXTIME was configured with.
+    const uint64_t time = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(departure.time_since_epoch()).count());
+
+    ::cmsghdr* header  = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type  = SCM_TXTIME;
+    header->cmsg_len   = CMSG_LEN(sizeof(time));
+    std::memcpy(CMSG_DATA(header), &time, sizeof(time));
+}
+
+// Extracts the ancillary data of a received message into the packet.
+void read_control_messages(::msghdr& message, packet& packet) noexcept
+{
+    for(::cmsghdr* header = CMSG_FIRSTHDR(&message); header != nullptr;
+        header            = CMSG_NXTHDR(&message, header))
+    {
+        if(header->cmsg_level == SOL_UDP && header->cmsg_type == UDP_GRO)
+        {
+            int segment_size;
+            std::memcpy(&segment_size, CMSG_DATA(header), sizeof(segment_size));
+
+            packet.segment_size = static_cast<size_t>(segment_size);
+        }
+        else if(header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_TIMESTAMPNS)
+        {
+            ::timespec timestamp;
+            std::memcpy(&timestamp, CMSG_DATA(header), sizeof(timestamp));
+
+            packet.timestamp = to_time_point(timestamp);
+        }
+        else if(header->cmsg_level == SOL_SOCKET && header->cmsg_type == SO_RXQ_OVFL)
+        {
+            std::memcpy(&packet.dropped, CMSG_DATA(header), sizeof(packet.dropped));
+        }
+        else if(header->cmsg_level == IPPROTO_IP && header->cmsg_type == IP_PKTINFO)
+        {
+            ::in_pktinfo info;
+            std::memcpy(&info, CMSG_DATA(header), sizeof(info));
+
+            packet.destination     = socket_address{ntohl(info.ipi_addr.s_addr), 0};
+            packet.interface_index = static_cast<uint32_t>(info.ipi_ifindex);
+        }
+        else if(header->cmsg_level == IPPROTO_IPV6 && header->cmsg_type == IPV6_PKTINFO)
+        {
+            ::in6_pktinfo info;
+            std::memcpy(&info, CMSG_DATA(header), sizeof(info));
+
+            packet.destination = socket_address{
+                std::span{(const uint8_t*)&info.ipi6_addr, sizeof(info.ipi6_addr)}, 0};
+            packet.interface_index = info.ipi6_ifindex;
+        }
+        else if(header->cmsg_level == IPPROTO_IP && header->cmsg_type == IP_TOS)
+        {
+            // Unlike most options, the IPV4 traffic class is reported as a single byte.
+            std::memcpy(&packet.traffic_class, CMSG_DATA(header), sizeof(packet.traffic_class));
+        }
+        else if(header->cmsg_level == IPPROTO_IPV6 && header->cmsg_type == IPV6_TCLASS)
+        {
+            int traffic_class;
+            std::memcpy(&traffic_class, CMSG_DATA(header), sizeof(traffic_class));
+
+            packet.traffic_class = static_cast<uint8_t>(traffic_class);
+        }
+    }
+}
+
+// A report read from the error queue of a socket.
+struct error_queue_report
+{
+    ::sock_extended_err extended_error     = {};
+    bool                has_extended_error = false;
+
+    // Software timestamp, if the report carries any.
+    ::timespec timestamp     = {};
+    bool       has_timestamp = false;
+};
+
+// Reads the next report from the error queue of a socket.
+error read_error_queue(socket::handle_t handle, error_queue_report& report) noexcept
+{
+    alignas(::cmsghdr) char control[control_buffer_size];
+
+    ::msghdr message       = {};
+    message.msg_control    = control;
+    message.msg_controllen = sizeof(control);
+
+    if(::recvmsg(handle, &message, MSG_ERRQUEUE) < 0)
+        return last_recv_error();
+
+    for(::cmsghdr* header = CMSG_FIRSTHDR(&message); header != nullptr;
+        header            = CMSG_NXTHDR(&message, header))
+    {
+        if((header->cmsg_level == SOL_IP && header->cmsg_type == IP_RECVERR)
+           || (header->cmsg_level == SOL_IPV6 && header->cmsg_type == IPV6_RECVERR))
+        {
+            std::memcpy(&report.extended_error, CMSG_DATA(header), sizeof(report.extended_error));
+            report.has_extended_error = true;
+        }
+        else if(header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_TIMESTAMPING)
+        {
+            // Software timestamps come first, followed by deprecated and hardware ones.
+            ::scm_timestamping timestamps;
+            std::memcpy(&timestamps, CMSG_DATA(header), sizeof(timestamps));
+
+            report.timestamp     = timestamps.ts[0];
+            report.has_timestamp = true;
+        }
+    }
+
+    return error::success();
+}
+#endif
+
+// Closes a socket handle.
+void close_handle(socket::handle_t handle) noexcept
+{
+#ifdef WIN32
+    (void)closesocket(handle);
+#else
+    (void)close(handle);
+#endif
+}
+
+// Closes a socket handle when going out of scope, unless released. Keeps constructors which throw
+// midway from leaking the handle.
+class handle_guard
+{
+public:
+    explicit handle_guard(socket::handle_t handle) noexcept : handle_m(handle)
+    {
+    }
+
+    ~handle_guard()
+    {
+        if(handle_m != detail::api_invalid_socket)
+            close_handle(handle_m);
+    }
+
+    handle_guard(const handle_guard&)            = delete;
+    handle_guard& operator=(const handle_guard&) = delete;
+
+    void release() noexcept
+    {
+        handle_m = detail::api_invalid_socket;
+    }
+
+private:
+    socket::handle_t handle_m;
+};
+
+// Sets an integer socket option.
+error set_int_option(socket::handle_t handle, int level, int name, int value) noexcept
+{
+    if(::setsockopt(handle, level, name, (char*)&value, sizeof(value)) == detail::api_socket_error)
+        return error{error_code::socket_option_unavailable, detail::get_socket_api_error()};
+
+    return error::success();
+}
+
+// Queries an integer socket option.
+expected<int, error> get_int_option(socket::handle_t handle, int level, int name) noexcept
+{
+    int       value  = 0;
+    socklen_t length = sizeof(value);
+    if(::getsockopt(handle, level, name, (char*)&value, &length) == detail::api_socket_error)
+    {
+        return make_unexpected<error>(error_code::socket_option_query_fail,
+                                      detail::get_socket_api_error());
+    }
+
+    return value;
+}
+
+// Level of the socket options concerning the given protocol.
+int protocol_level(socket_protocol protocol) noexcept
+{
+    return protocol == socket_protocol::ipv6 ? IPPROTO_IPV6 : IPPROTO_IP;
+}
+
+// Replaces the ECN codepoint of a traffic class option, keeping the DSCP.
+error set_ecn_bits(socket::handle_t handle, int level, int name, ecn_codepoint codepoint) noexcept
+{
+    auto traffic_class = get_int_option(handle, level, name);
+    if(!traffic_class)
+        return traffic_class.error();
+
+    return set_int_option(
+        handle, level, name, (*traffic_class & ~0b11) | static_cast<int>(codepoint));
+}
+
+// Joins or leaves a multicast group, optionally only for packets from a single source.
+error change_membership(socket::handle_t      handle,
+                        int                   name,
+                        socket_address        group,
+                        const socket_address* source,
+                        uint32_t              interface_index) noexcept
+{
+    native_address native_group;
+    to_native_address(group.protocol(), group, native_group);
+
+    int result;
+    if(source != nullptr)
+    {
+        native_address native_source;
+        to_native_address(group.protocol(), *source, native_source);
+
+        ::group_source_req request = {};
+        request.gsr_interface      = interface_index;
+        std::memcpy(&request.gsr_group, &native_group, sizeof(native_group));
+        std::memcpy(&request.gsr_source, &native_source, sizeof(native_source));
+
+        result = ::setsockopt(
+            handle, protocol_level(group.protocol()), name, (char*)&request, sizeof(request));
+    }
+    else
+    {
+        ::group_req request  = {};
+        request.gr_interface = interface_index;
+        std::memcpy(&request.gr_group, &native_group, sizeof(native_group));
+
+        result = ::setsockopt(
+            handle, protocol_level(group.protocol()), name, (char*)&request, sizeof(request));
+    }
+
+    if(result == detail::api_socket_error)
+        return error{error_code::multicast_membership_fail, detail::get_socket_api_error()};
+
+    return error::success();
+}
+
+// Sets the interface IPV4 multicast packets are sent through, by index.
+error set_ipv4_multicast_interface(socket::handle_t handle, uint32_t interface_index) noexcept
+{
+#if defined(__linux__) || defined(WIN32)
+#ifdef WIN32
+    // Winsock takes an interface index in network order, rather than an interface address.
+    DWORD request = htonl(interface_index);
+#else
+    ::ip_mreqn request  = {};
+    request.imr_ifindex = static_cast<int>(interface_index);
+#endif
+
+    if(::setsockopt(handle, IPPROTO_IP, IP_MULTICAST_IF, (char*)&request, sizeof(request))
+       == detail::api_socket_error)
+    {
+        return error{error_code::socket_option_unavailable, detail::get_socket_api_error()};
+    }
+
+    return error::success();
+#else
+    // Elsewhere, IPV4 multicast interfaces can only be selected by address.
+    (void)handle;
+    (void)interface_index;
+    return error{error_code::socket_option_unavailable, 0};
+#endif
+}
+
+// Sets the size of a socket buffer. Where possible, the limits imposed on unprivileged processes
+// are bypassed.
+error set_buffer_size(socket::handle_t handle, int name, int force_name, size_t size) noexcept
+{
+    const int native_size = static_cast<int>(std::min<size_t>(size, INT_MAX));
+
+#ifdef __linux__
+    if(set_int_option(handle, SOL_SOCKET, force_name, native_size) == error_code::none)
+        return error::success();
+#else
+    (void)force_name;
+#endif
+
+    return set_int_option(handle, SOL_SOCKET, name, native_size);
+}
+
+} // namespace
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // Socket API wrapper implementation.
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -45,14 +408,19 @@ socket_api& socket_api::operator=(socket_api&& other) noexcept
 
 socket::socket(socket_protocol protocol, socket_flags flags) :
     protocol_m(protocol),
+    flags_m(flags),
     handle_m(
-        ::socket(protocol == socket_protocol::ipv6 ? AF_INET6 : AF_INET, SOCK_DGRAM, IPPROTO_UDP))
+        ::socket(protocol == socket_protocol::ipv6 ? AF_INET6 : AF_INET, SOCK_DGRAM, IPPROTO_UDP)),
+    connected_m(false),
+    zerocopy_next_m(0)
 {
     if(handle_m == detail::api_invalid_socket)
     {
         throw exception{error_code::socket_creation_fail, detail::get_socket_api_error()};
     }
 
+    handle_guard guard{handle_m};
+
     if(protocol == socket_protocol::ipv6 && detail::enum_get(flags, socket_flags::dual_stack))
     {
         int enable = 0;
@@ -64,6 +432,155 @@ socket::socket(socket_protocol protocol, socket_flags flags) :
         }
     }
 
+    if(detail::enum_get(flags, socket_flags::udp_gro))
+    {
+#ifdef __linux__
+        int enable = 1;
+        if(setsockopt(handle_m, SOL_UDP, UDP_GRO, (char*)&enable, sizeof(enable))
+           == detail::api_socket_error)
+        {
+            throw exception{error_code::socket_option_unavailable, detail::get_socket_api_error()};
+        }
+#else
+        throw exception{error_code::socket_option_unavailable, 0};
+#endif
+    }
+
+    if(detail::enum_get(flags, socket_flags::reuse_port))
+    {
+#ifdef SO_REUSEPORT
+        int enable = 1;
+        if(setsockopt(handle_m, SOL_SOCKET, SO_REUSEPORT, (char*)&enable, sizeof(enable))
+           == detail::api_socket_error)
+        {
+            throw exception{error_code::socket_option_unavailable, detail::get_socket_api_error()};
+        }
+#else
+        throw exception{error_code::socket_option_unavailable, 0};
+#endif
+    }
+
+    if(detail::enum_get(flags, socket_flags::rx_timestamps))
+    {
+#ifdef __linux__
+        int enable = 1;
+        if(setsockopt(handle_m, SOL_SOCKET, SO_TIMESTAMPNS, (char*)&enable, sizeof(enable))
+           == detail::api_socket_error)
+        {
+            throw exception{error_code::socket_option_unavailable, detail::get_socket_api_error()};
+        }
+#else
+        throw exception{error_code::socket_option_unavailable, 0};
+#endif
+    }
+
+    if(detail::enum_get(flags, socket_flags::drop_counter))
+    {
+#ifdef __linux__
+        int enable = 1;
+        if(setsockopt(handle_m, SOL_SOCKET, SO_RXQ_OVFL, (char*)&enable, sizeof(enable))
+           == detail::api_socket_error)
+        {
+            throw exception{error_code::socket_option_unavailable, detail::get_socket_api_error()};
+        }
+#else
+        throw exception{error_code::socket_option_unavailable, 0};
+#endif
+    }
+
+    if(detail::enum_get(flags, socket_flags::packet_info))
+    {
+#ifdef __linux__
+        const int level = protocol == socket_protocol::ipv6 ? IPPROTO_IPV6 : IPPROTO_IP;
+        const int name  = protocol == socket_protocol::ipv6 ? IPV6_RECVPKTINFO : IP_PKTINFO;
+
+        int enable = 1;
+        if(setsockopt(handle_m, level, name, (char*)&enable, sizeof(enable))
+           == detail::api_socket_error)
+        {
+            throw exception{error_code::socket_option_unavailable, detail::get_socket_api_error()};
+        }
+#else
+        throw exception{error_code::socket_option_unavailable, 0};
+#endif
+    }
+
+    if(detail::enum_get(flags, socket_flags::ecn))
+    {
+#ifdef __linux__
+        int enable = 1;
+
+        // IPV4 packets received by dual-stack sockets carry the IPV4 traffic class.
+        if(protocol == socket_protocol::ipv4 || detail::enum_get(flags, socket_flags::dual_stack))
+        {
+            if(setsockopt(handle_m, IPPROTO_IP, IP_RECVTOS, (char*)&enable, sizeof(enable))
+               == detail::api_socket_error)
+            {
+                throw exception{error_code::socket_option_unavailable,
+                                detail::get_socket_api_error()};
+            }
+        }
+
+        if(protocol == socket_protocol::ipv6
+           && setsockopt(handle_m, IPPROTO_IPV6, IPV6_RECVTCLASS, (char*)&enable, sizeof(enable))
+                  == detail::api_socket_error)
+        {
+            throw exception{error_code::socket_option_unavailable, detail::get_socket_api_error()};
+        }
+#else
+        throw exception{error_code::socket_option_unavailable, 0};
+#endif
+    }
+
+    if(detail::enum_get(flags, socket_flags::txtime))
+    {
+#ifdef __linux__
+        // The fq queueing discipline schedules departures against the monotonic clock.
+        ::sock_txtime config = {};
+        config.clockid       = CLOCK_MONOTONIC;
+
+        if(setsockopt(handle_m, SOL_SOCKET, SO_TXTIME, (char*)&config, sizeof(config))
+           == detail::api_socket_error)
+        {
+            throw exception{error_code::socket_option_unavailable, detail::get_socket_api_error()};
+        }
+#else
+        throw exception{error_code::socket_option_unavailable, 0};
+#endif
+    }
+
+    if(detail::enum_get(flags, socket_flags::tx_timestamps))
+    {
+#ifdef __linux__
+        // Only timestamps are looped back, rather than whole datagrams, and they carry the ID of
+        // the send.
+        int options = SOF_TIMESTAMPING_TX_SCHED | SOF_TIMESTAMPING_TX_SOFTWARE
+                      | SOF_TIMESTAMPING_SOFTWARE | SOF_TIMESTAMPING_OPT_ID
+                      | SOF_TIMESTAMPING_OPT_TSONLY;
+        if(setsockopt(handle_m, SOL_SOCKET, SO_TIMESTAMPING, (char*)&options, sizeof(options))
+           == detail::api_socket_error)
+        {
+            throw exception{error_code::socket_option_unavailable, detail::get_socket_api_error()};
+        }
+#else
+        throw exception{error_code::socket_option_unavailable, 0};
+#endif
+    }
+
+    if(detail::enum_get(flags, socket_flags::zerocopy))
+    {
+#ifdef __linux__
+        int enable = 1;
+        if(setsockopt(handle_m, SOL_SOCKET, SO_ZEROCOPY, (char*)&enable, sizeof(enable))
+           == detail::api_socket_error)
+        {
+            throw exception{error_code::socket_option_unavailable, detail::get_socket_api_error()};
+        }
+#else
+        throw exception{error_code::socket_option_unavailable, 0};
+#endif
+    }
+
 #ifdef WIN32
     unsigned long mode = 1;
     if(::ioctlsocket(handle_m, FIONBIO, (unsigned long*)&mode) == detail::api_socket_error)
@@ -78,19 +595,23 @@ socket::socket(socket_protocol protocol, socket_flags flags) :
     if(fcntl(handle_m, F_SETFL, native_flags) == detail::api_socket_error)
         throw exception{error_code::socket_mode_fail, detail::get_socket_api_error()};
 #endif
+
+    guard.release();
 }
 
 socket::~socket()
 {
     if(handle_m != detail::api_invalid_socket)
-#ifdef WIN32
-        (void)closesocket(handle_m);
-#else
-        (void)close(handle_m);
-#endif
+        close_handle(handle_m);
 }
 
-socket::socket(socket&& other) noexcept : handle_m(other.handle_m), protocol_m(other.protocol_m)
+socket::socket(socket&& other) noexcept :
+    protocol_m(other.protocol_m),
+    flags_m(other.flags_m),
+    handle_m(other.handle_m),
+    peer_m(other.peer_m),
+    connected_m(other.connected_m),
+    zerocopy_next_m(other.zerocopy_next_m)
 {
     other.handle_m = detail::api_invalid_socket;
 }
@@ -100,6 +621,11 @@ socket& socket::operator=(socket&& other) noexcept
     handle_m       = other.handle_m;
     other.handle_m = detail::api_invalid_socket;
     protocol_m     = other.protocol_m;
+    flags_m        = other.flags_m;
+    peer_m         = other.peer_m;
+    connected_m    = other.connected_m;
+
+    zerocopy_next_m = other.zerocopy_next_m;
     return *this;
 }
 
@@ -108,39 +634,17 @@ socket_protocol socket::protocol() const noexcept
     return protocol_m;
 }
 
-error socket::bind(socket_address address) const noexcept
+socket::handle_t socket::native_handle() const noexcept
 {
-    union
-    {
-        ::sockaddr_in  address_ipv4;
-        ::sockaddr_in6 address_ipv6;
-    };
-
-    sockaddr* native_address;
-    socklen_t native_address_length;
-    if(protocol_m == socket_protocol::ipv6)
-    {
-        native_address        = (sockaddr*)&address_ipv6;
-        native_address_length = sizeof(address_ipv6);
-
-        address_ipv6             = {};
-        address_ipv6.sin6_family = AF_INET6;
-        address_ipv6.sin6_port   = address.port_network_order();
-
-        std::memcpy(&address_ipv6.sin6_addr, address.ipv6().data(), address.ipv6().size());
-    }
-    else
-    {
-        native_address        = (sockaddr*)&address_ipv4;
-        native_address_length = sizeof(address_ipv4);
+    return handle_m;
+}
 
-        address_ipv4                 = {};
-        address_ipv4.sin_family      = AF_INET;
-        address_ipv4.sin_addr.s_addr = address.ipv4();
-        address_ipv4.sin_port        = address.port_network_order();
-    }
+error socket::bind(socket_address address) const noexcept
+{
+    native_address  native;
+    const socklen_t native_length = to_native_address(protocol_m, address, native);
 
-    if(::bind(handle_m, native_address, native_address_length) == detail::api_socket_error)
+    if(::bind(handle_m, &native.generic, native_length) == detail::api_socket_error)
     {
         return error{error_code::socket_bind_error, detail::get_socket_api_error()};
     }
@@ -150,138 +654,1099 @@ error socket::bind(socket_address address) const noexcept
 
 expected<socket_address, error> socket::address() const noexcept
 {
-    union
-    {
-        ::sockaddr_in  address_ipv4;
-        ::sockaddr_in6 address_ipv6;
-    };
+    native_address address;
+    socklen_t      address_length = native_address_length(protocol_m);
 
-    sockaddr* address;
-    socklen_t address_length;
-    if(protocol_m == socket_protocol::ipv6)
-    {
-        address        = (sockaddr*)&address_ipv6;
-        address_length = sizeof(address_ipv6);
-    }
-    else
-    {
-        address        = (sockaddr*)&address_ipv4;
-        address_length = sizeof(address_ipv4);
-    }
-
-    if(::getsockname(handle_m, address, &address_length) == detail::api_socket_error)
+    if(::getsockname(handle_m, &address.generic, &address_length) == detail::api_socket_error)
     {
         return make_unexpected<error>(error_code::socket_address_query_fail,
                                       detail::get_socket_api_error());
     }
 
-    if(protocol_m == socket_protocol::ipv6)
+    return from_native_address(protocol_m, address);
+}
+
+expected<int, error> socket::incoming_cpu() const noexcept
+{
+#ifdef __linux__
+    return get_int_option(handle_m, SOL_SOCKET, SO_INCOMING_CPU);
+#else
+    return make_unexpected<error>(error_code::socket_option_query_fail, 0);
+#endif
+}
+
+error socket::set_incoming_cpu(int cpu) const noexcept
+{
+#ifdef __linux__
+    return set_int_option(handle_m, SOL_SOCKET, SO_INCOMING_CPU, cpu);
+#else
+    (void)cpu;
+    return error{error_code::socket_option_unavailable, 0};
+#endif
+}
+
+error socket::set_busy_poll(std::chrono::microseconds timeout,
+                            bool                      prefer,
+                            uint16_t                  budget) const noexcept
+{
+#ifdef __linux__
+    const int native_timeout = static_cast<int>(std::min<int64_t>(timeout.count(), INT_MAX));
+
+    auto timeout_error = set_int_option(handle_m, SOL_SOCKET, SO_BUSY_POLL, native_timeout);
+    if(timeout_error != error_code::none)
+        return timeout_error;
+
+    // Older kernels (before 5.11) don't know SO_PREFER_BUSY_POLL, so it's only set when asked for.
+    if(prefer)
     {
-        // Port in host byte order.
-        const uint16_t port = ntohs(((sockaddr_in6*)address)->sin6_port);
+        auto prefer_error = set_int_option(handle_m, SOL_SOCKET, SO_PREFER_BUSY_POLL, 1);
+        if(prefer_error != error_code::none)
+            return prefer_error;
+    }
+
+    if(budget != 0)
+        return set_int_option(handle_m, SOL_SOCKET, SO_BUSY_POLL_BUDGET, budget);
+
+    return error::success();
+#else
+    (void)timeout;
+    (void)prefer;
+    (void)budget;
+    return error{error_code::socket_option_unavailable, 0};
+#endif
+}
 
-        return socket_address{
-            std::span{(uint8_t*)&address_ipv6.sin6_addr, sizeof(address_ipv6.sin6_addr)},
-            port};
+expected<uint32_t, error> socket::dropped_packets() const noexcept
+{
+#ifdef __linux__
+    uint32_t  memory_info[SK_MEMINFO_VARS] = {};
+    socklen_t length                       = sizeof(memory_info);
+    if(::getsockopt(handle_m, SOL_SOCKET, SO_MEMINFO, memory_info, &length)
+       == detail::api_socket_error)
+    {
+        return make_unexpected<error>(error_code::socket_option_query_fail,
+                                      detail::get_socket_api_error());
     }
-    else
+
+    return uint32_t{memory_info[SK_MEMINFO_DROPS]};
+#else
+    return make_unexpected<error>(error_code::socket_option_query_fail, 0);
+#endif
+}
+
+error socket::set_recv_buffer_size(size_t size) const noexcept
+{
+#ifdef __linux__
+    return set_buffer_size(handle_m, SO_RCVBUF, SO_RCVBUFFORCE, size);
+#else
+    return set_buffer_size(handle_m, SO_RCVBUF, 0, size);
+#endif
+}
+
+error socket::set_send_buffer_size(size_t size) const noexcept
+{
+#ifdef __linux__
+    return set_buffer_size(handle_m, SO_SNDBUF, SO_SNDBUFFORCE, size);
+#else
+    return set_buffer_size(handle_m, SO_SNDBUF, 0, size);
+#endif
+}
+
+expected<size_t, error> socket::recv_buffer_size() const noexcept
+{
+    auto size = get_int_option(handle_m, SOL_SOCKET, SO_RCVBUF);
+    if(!size)
+        return make_unexpected<error>(size.error());
+
+    return static_cast<size_t>(*size);
+}
+
+expected<size_t, error> socket::send_buffer_size() const noexcept
+{
+    auto size = get_int_option(handle_m, SOL_SOCKET, SO_SNDBUF);
+    if(!size)
+        return make_unexpected<error>(size.error());
+
+    return static_cast<size_t>(*size);
+}
+
+expected<buffer_occupancy, error> socket::occupancy() const noexcept
+{
+#ifdef __linux__
+    uint32_t  memory_info[SK_MEMINFO_VARS] = {};
+    socklen_t length                       = sizeof(memory_info);
+    if(::getsockopt(handle_m, SOL_SOCKET, SO_MEMINFO, memory_info, &length)
+       == detail::api_socket_error)
+    {
+        return make_unexpected<error>(error_code::socket_option_query_fail,
+                                      detail::get_socket_api_error());
+    }
+
+    buffer_occupancy occupancy;
+    occupancy.recv_queued = memory_info[SK_MEMINFO_RMEM_ALLOC];
+    occupancy.recv_size   = memory_info[SK_MEMINFO_RCVBUF];
+    occupancy.send_queued = memory_info[SK_MEMINFO_WMEM_ALLOC];
+    occupancy.send_size   = memory_info[SK_MEMINFO_SNDBUF];
+    return occupancy;
+#else
+    return make_unexpected<error>(error_code::socket_option_query_fail, 0);
+#endif
+}
+
+error socket::join_group(socket_address group, uint32_t interface_index) const noexcept
+{
+    return change_membership(handle_m, MCAST_JOIN_GROUP, group, nullptr, interface_index);
+}
+
+error socket::leave_group(socket_address group, uint32_t interface_index) const noexcept
+{
+    return change_membership(handle_m, MCAST_LEAVE_GROUP, group, nullptr, interface_index);
+}
+
+error socket::join_source_group(socket_address group,
+                                socket_address source,
+                                uint32_t       interface_index) const noexcept
+{
+    return change_membership(handle_m, MCAST_JOIN_SOURCE_GROUP, group, &source, interface_index);
+}
+
+error socket::leave_source_group(socket_address group,
+                                 socket_address source,
+                                 uint32_t       interface_index) const noexcept
+{
+    return change_membership(handle_m, MCAST_LEAVE_SOURCE_GROUP, group, &source, interface_index);
+}
+
+error socket::set_multicast_interface(uint32_t interface_index) const noexcept
+{
+    if(protocol_m == socket_protocol::ipv4)
+        return set_ipv4_multicast_interface(handle_m, interface_index);
+
+    // Dual-stack sockets send to IPV4 groups through the IPV4 multicast interface, which is best
+    // effort for the same reason as in set_multicast_option.
+    if(detail::enum_get(flags_m, socket_flags::dual_stack))
+        (void)set_ipv4_multicast_interface(handle_m, interface_index);
+
+    return set_int_option(
+        handle_m, IPPROTO_IPV6, IPV6_MULTICAST_IF, static_cast<int>(interface_index));
+}
+
+error socket::set_pacing_rate(uint64_t bytes_per_second) const noexcept
+{
+#ifdef __linux__
+    // The kernel takes the rate as an unsigned long, and its all-ones value disables pacing.
+    const unsigned long rate =
+        static_cast<unsigned long>(std::min<uint64_t>(bytes_per_second, ULONG_MAX));
+
+    if(::setsockopt(handle_m, SOL_SOCKET, SO_MAX_PACING_RATE, (char*)&rate, sizeof(rate))
+       == detail::api_socket_error)
     {
-        // Address in host byte order.
-        const uint32_t addr = ntohl(address_ipv4.sin_addr.s_addr);
+        return error{error_code::socket_option_unavailable, detail::get_socket_api_error()};
+    }
+
+    return error::success();
+#else
+    (void)bytes_per_second;
+    return error{error_code::socket_option_unavailable, 0};
+#endif
+}
+
+error socket::set_ecn(ecn_codepoint codepoint) const noexcept
+{
+#ifndef WIN32
+    if(protocol_m == socket_protocol::ipv4)
+        return set_ecn_bits(handle_m, IPPROTO_IP, IP_TOS, codepoint);
+
+    // Dual-stack sockets send to IPV4 addresses with the IPV4 traffic class.
+    if(detail::enum_get(flags_m, socket_flags::dual_stack))
+        (void)set_ecn_bits(handle_m, IPPROTO_IP, IP_TOS, codepoint);
+
+    return set_ecn_bits(handle_m, IPPROTO_IPV6, IPV6_TCLASS, codepoint);
+#else
+    // Windows silently ignores the traffic class set by applications.
+    (void)codepoint;
+    return error{error_code::socket_option_unavailable, 0};
+#endif
+}
+
+error socket::set_multicast_loop(bool enable) const noexcept
+{
+    return set_multicast_option(IP_MULTICAST_LOOP, IPV6_MULTICAST_LOOP, enable ? 1 : 0);
+}
+
+error socket::set_multicast_ttl(uint8_t ttl) const noexcept
+{
+    return set_multicast_option(IP_MULTICAST_TTL, IPV6_MULTICAST_HOPS, ttl);
+}
+
+error socket::set_multicast_option(int ipv4_name, int ipv6_name, int value) const noexcept
+{
+    if(protocol_m == socket_protocol::ipv4)
+        return set_int_option(handle_m, IPPROTO_IP, ipv4_name, value);
 
-        // Port in host byte order.
-        const uint16_t port = ntohs(((sockaddr_in*)address)->sin_port);
+    // Dual-stack sockets also send to IPV4 groups, which are governed by IPV4 options. Not every
+    // platform lets them be set on IPV6 sockets, so this is best effort.
+    if(detail::enum_get(flags_m, socket_flags::dual_stack))
+        (void)set_int_option(handle_m, IPPROTO_IP, ipv4_name, value);
 
-        return socket_address{addr, port};
+    return set_int_option(handle_m, IPPROTO_IPV6, ipv6_name, value);
+}
+
+error socket::connect(socket_address address) noexcept
+{
+    native_address  native;
+    const socklen_t native_length = to_native_address(protocol_m, address, native);
+
+    if(::connect(handle_m, &native.generic, native_length) == detail::api_socket_error)
+    {
+        return error{error_code::socket_connect_error, detail::get_socket_api_error()};
     }
+
+    peer_m      = address;
+    connected_m = true;
+
+    return error::success();
+}
+
+error socket::send(std::span<const char> buffer) const noexcept
+{
+    if(::send(handle_m, buffer.data(), buffer.size(), 0) < 0)
+        return last_send_error();
+
+    return error::success();
 }
 
 error socket::send(socket_address destination, std::span<const char> buffer) const noexcept
 {
-    union
+    native_address  address;
+    const socklen_t address_length = to_native_address(protocol_m, destination, address);
+
+    if(::sendto(handle_m, buffer.data(), buffer.size(), 0, &address.generic, address_length) < 0)
     {
-        ::sockaddr_in  address_ipv4;
-        ::sockaddr_in6 address_ipv6;
-    };
+        return last_send_error();
+    }
+
+    return error::success();
+}
+
+error socket::send(socket_address                         destination,
+                   std::span<const std::span<const char>> buffers) const noexcept
+{
+    if(buffers.size() > max_buffer_count)
+        return error{error_code::socket_send_error, EINVAL};
+
+    native_address  address;
+    const socklen_t address_length = to_native_address(protocol_m, destination, address);
 
-    sockaddr* address;
-    socklen_t address_length;
+#ifdef WIN32
+    WSABUF vectors[max_buffer_count];
+    for(size_t i = 0; i < buffers.size(); ++i)
+    {
+        vectors[i].buf = (char*)buffers[i].data();
+        vectors[i].len = static_cast<ULONG>(buffers[i].size());
+    }
+
+    DWORD sent = 0;
+    if(::WSASendTo(handle_m,
+                   vectors,
+                   static_cast<DWORD>(buffers.size()),
+                   &sent,
+                   0,
+                   &address.generic,
+                   address_length,
+                   nullptr,
+                   nullptr)
+       == detail::api_socket_error)
+    {
+        return last_send_error();
+    }
+#else
+    ::iovec vectors[max_buffer_count];
+    for(size_t i = 0; i < buffers.size(); ++i)
+    {
+        vectors[i].iov_base = (void*)buffers[i].data();
+        vectors[i].iov_len  = buffers[i].size();
+    }
+
+    ::msghdr message    = {};
+    message.msg_name    = &address;
+    message.msg_namelen = address_length;
+    message.msg_iov     = vectors;
+    message.msg_iovlen  = buffers.size();
+
+    if(::sendmsg(handle_m, &message, 0) < 0)
+        return last_send_error();
+#endif
+
+    return error::success();
+}
+
+error socket::send(socket_address        destination,
+                   std::span<const char> buffer,
+                   socket_address        source,
+                   uint32_t              interface_index) const noexcept
+{
+#ifdef __linux__
+    native_address  address;
+    const socklen_t address_length = to_native_address(protocol_m, destination, address);
+
+    ::iovec vector;
+    vector.iov_base = (void*)buffer.data();
+    vector.iov_len  = buffer.size();
+
+    alignas(::cmsghdr) char control[CMSG_SPACE(sizeof(::in6_pktinfo))] = {};
+
+    ::msghdr message       = {};
+    message.msg_name       = &address;
+    message.msg_namelen    = address_length;
+    message.msg_iov        = &vector;
+    message.msg_iovlen     = 1;
+    message.msg_control    = control;
+    message.msg_controllen = sizeof(control);
+
+    ::cmsghdr* header = CMSG_FIRSTHDR(&message);
     if(protocol_m == socket_protocol::ipv6)
     {
-        address        = (sockaddr*)&address_ipv6;
-        address_length = sizeof(address_ipv6);
+        ::in6_pktinfo info = {};
+        std::memcpy(&info.ipi6_addr, source.ipv6().data(), source.ipv6().size());
+        info.ipi6_ifindex = interface_index;
 
-        address_ipv6             = {};
-        address_ipv6.sin6_family = AF_INET6;
-        address_ipv6.sin6_port   = destination.port_network_order();
+        header->cmsg_level = IPPROTO_IPV6;
+        header->cmsg_type  = IPV6_PKTINFO;
+        header->cmsg_len   = CMSG_LEN(sizeof(info));
+        std::memcpy(CMSG_DATA(header), &info, sizeof(info));
 
-        std::memcpy(&address_ipv6.sin6_addr, destination.ipv6().data(), destination.ipv6().size());
+        message.msg_controllen = CMSG_SPACE(sizeof(info));
     }
     else
     {
-        address        = (sockaddr*)&address_ipv4;
-        address_length = sizeof(address_ipv4);
+        ::in_pktinfo info        = {};
+        info.ipi_spec_dst.s_addr = source.ipv4();
+        info.ipi_ifindex         = static_cast<int>(interface_index);
+
+        header->cmsg_level = IPPROTO_IP;
+        header->cmsg_type  = IP_PKTINFO;
+        header->cmsg_len   = CMSG_LEN(sizeof(info));
+        std::memcpy(CMSG_DATA(header), &info, sizeof(info));
 
-        address_ipv4                 = {};
-        address_ipv4.sin_family      = AF_INET;
-        address_ipv4.sin_port        = destination.port_network_order();
-        address_ipv4.sin_addr.s_addr = destination.ipv4();
+        message.msg_controllen = CMSG_SPACE(sizeof(info));
     }
 
-    if(::sendto(handle_m, buffer.data(), buffer.size(), 0, (const sockaddr*)address, address_length)
-       == detail::api_socket_error)
+    if(::sendmsg(handle_m, &message, 0) < 0)
+        return last_send_error();
+
+    return error::success();
+#else
+    (void)destination;
+    (void)buffer;
+    (void)source;
+    (void)interface_index;
+    return error{error_code::socket_send_error, 0};
+#endif
+}
+
+error socket::send_at(socket_address                        destination,
+                      std::span<const char>                 buffer,
+                      std::chrono::steady_clock::time_point departure) const noexcept
+{
+#ifdef __linux__
+    if(!detail::enum_get(flags_m, socket_flags::txtime))
+        return error{error_code::socket_send_error, EINVAL};
+
+    native_address  address;
+    const socklen_t address_length = to_native_address(protocol_m, destination, address);
+
+    ::iovec vector;
+    vector.iov_base = (void*)buffer.data();
+    vector.iov_len  = buffer.size();
+
+    alignas(::cmsghdr) char control[departure_control_size] = {};
+
+    ::msghdr message    = {};
+    message.msg_name    = &address;
+    message.msg_namelen = address_length;
+    message.msg_iov     = &vector;
+    message.msg_iovlen  = 1;
+    set_departure(message, control, departure);
+
+    if(::sendmsg(handle_m, &message, 0) < 0)
+        return last_send_error();
+
+    return error::success();
+#else
+    (void)destination;
+    (void)buffer;
+    (void)departure;
+    return error{error_code::socket_send_error, 0};
+#endif
+}
+
+error socket::send(const socket_endpoint& endpoint, std::span<const char> buffer) const noexcept
+{
+    assert(endpoint.protocol() == protocol_m);
+
+    if(::sendto(handle_m,
+                buffer.data(),
+                buffer.size(),
+                0,
+                (const ::sockaddr*)endpoint.storage_m,
+                static_cast<socklen_t>(endpoint.size_m))
+       < 0)
     {
-        return error{error_code::socket_send_error, detail::get_socket_api_error()};
+        return last_send_error();
     }
 
     return error::success();
 }
 
+expected<size_t, error> socket::send_batch(std::span<const outgoing_packet> packets) const noexcept
+{
+    size_t sent = 0;
+
+#ifdef __linux__
+    ::mmsghdr      messages[max_batch_size];
+    ::iovec        vectors[max_batch_size];
+    native_address addresses[max_batch_size];
+
+    alignas(::cmsghdr) char controls[max_batch_size][departure_control_size];
+    const bool              paced = detail::enum_get(flags_m, socket_flags::txtime);
+
+    while(sent < packets.size())
+    {
+        const auto   batch = packets.subspan(sent, std::min(packets.size() - sent, max_batch_size));
+        const size_t count = batch.size();
+
+        for(size_t i = 0; i < count; ++i)
+        {
+            const socklen_t address_length =
+                to_native_address(protocol_m, batch[i].address, addresses[i]);
+
+            vectors[i].iov_base = (void*)batch[i].payload.data();
+            vectors[i].iov_len  = batch[i].payload.size();
+
+            messages[i]                     = {};
+            messages[i].msg_hdr.msg_name    = &addresses[i];
+            messages[i].msg_hdr.msg_namelen = address_length;
+            messages[i].msg_hdr.msg_iov     = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen  = 1;
+
+            if(paced && batch[i].departure != std::chrono::steady_clock::time_point{})
+                set_departure(messages[i].msg_hdr, controls[i], batch[i].departure);
+        }
+
+        const int batch_sent = ::sendmmsg(handle_m, messages, count, 0);
+        if(batch_sent < 0)
+            break;
+
+        sent += static_cast<size_t>(batch_sent);
+
+        // The socket stopped accepting data midway through the batch.
+        if(static_cast<size_t>(batch_sent) < count)
+            return sent;
+    }
+#else
+    // No batched send available - fall back to sending one packet at a time.
+    for(; sent < packets.size(); ++sent)
+    {
+        if(send(packets[sent].address, packets[sent].payload) != error_code::none)
+            break;
+    }
+#endif
+
+    if(sent == 0 && !packets.empty())
+        return make_unexpected<error>(last_send_error());
+
+    return sent;
+}
+
+expected<size_t, error> socket::send_segmented(socket_address        destination,
+                                               std::span<const char> buffer,
+                                               size_t                segment_size) const noexcept
+{
+    if(segment_size == 0)
+        return make_unexpected<error>(error_code::socket_send_error, EINVAL);
+
+    native_address  address;
+    const socklen_t address_length = to_native_address(protocol_m, destination, address);
+
+    size_t sent = 0;
+
+#ifdef __linux__
+    // The kernel limits a single segmented send both in segment count and in total size, which
+    // can't exceed the largest possible UDP payload.
+    constexpr size_t max_segments = 64;
+    constexpr size_t max_payload  = 65507;
+
+    const size_t segments_per_send = std::min(max_segments, max_payload / segment_size);
+
+    while(segments_per_send > 1 && sent < buffer.size())
+    {
+        const auto chunk = buffer.subspan(
+            sent, std::min(buffer.size() - sent, segments_per_send * segment_size));
+
+        ::iovec vector;
+        vector.iov_base = (void*)chunk.data();
+        vector.iov_len  = chunk.size();
+
+        alignas(::cmsghdr) char control[CMSG_SPACE(sizeof(uint16_t))] = {};
+
+        ::msghdr message       = {};
+        message.msg_name       = &address;
+        message.msg_namelen    = address_length;
+        message.msg_iov        = &vector;
+        message.msg_iovlen     = 1;
+        message.msg_control    = control;
+        message.msg_controllen = sizeof(control);
+
+        ::cmsghdr* header  = CMSG_FIRSTHDR(&message);
+        header->cmsg_level = SOL_UDP;
+        header->cmsg_type  = UDP_SEGMENT;
+        header->cmsg_len   = CMSG_LEN(sizeof(uint16_t));
+
+        const uint16_t native_segment_size = static_cast<uint16_t>(segment_size);
+        std::memcpy(CMSG_DATA(header), &native_segment_size, sizeof(native_segment_size));
+
+        if(::sendmsg(handle_m, &message, 0) < 0)
+        {
+            const auto api_error = detail::get_socket_api_error();
+
+            // Segmentation offload is not supported by the kernel or by the device - fall back to
+            // sending segments one by one.
+            if(api_error == EIO || api_error == EINVAL || api_error == ENOPROTOOPT
+               || api_error == EOPNOTSUPP)
+            {
+                break;
+            }
+
+            if(sent == 0)
+                return make_unexpected<error>(last_send_error());
+
+            return sent;
+        }
+
+        sent += chunk.size();
+    }
+#endif
+
+    while(sent < buffer.size())
+    {
+        const auto segment = buffer.subspan(sent, std::min(buffer.size() - sent, segment_size));
+
+        if(::sendto(handle_m, segment.data(), segment.size(), 0, &address.generic, address_length)
+           < 0)
+        {
+            if(sent == 0)
+                return make_unexpected<error>(last_send_error());
+
+            return sent;
+        }
+
+        sent += segment.size();
+    }
+
+    return sent;
+}
+
+expected<uint32_t, error> socket::send_zerocopy(socket_address        destination,
+                                                std::span<const char> buffer) const noexcept
+{
+#ifdef __linux__
+    if(!detail::enum_get(flags_m, socket_flags::zerocopy))
+        return make_unexpected<error>(error_code::socket_send_error, EINVAL);
+
+    native_address  address;
+    const socklen_t address_length = to_native_address(protocol_m, destination, address);
+
+    ::iovec vector;
+    vector.iov_base = (void*)buffer.data();
+    vector.iov_len  = buffer.size();
+
+    ::msghdr message    = {};
+    message.msg_name    = &address;
+    message.msg_namelen = address_length;
+    message.msg_iov     = &vector;
+    message.msg_iovlen  = 1;
+
+    if(::sendmsg(handle_m, &message, MSG_ZEROCOPY) < 0)
+        return make_unexpected<error>(last_send_error());
+
+    // The kernel only consumes an ID when the send succeeds.
+    return zerocopy_next_m++;
+#else
+    (void)destination;
+    (void)buffer;
+    return make_unexpected<error>(error_code::socket_send_error, 0);
+#endif
+}
+
+expected<zerocopy_completion, error> socket::poll_zerocopy() const noexcept
+{
+#ifdef __linux__
+    for(;;)
+    {
+        error_queue_report report;
+
+        const error read_error = read_error_queue(handle_m, report);
+        if(read_error != error_code::none)
+            return make_unexpected<error>(read_error);
+
+        // Not a zero-copy notification - the error queue holds other reports too, skip it.
+        if(!report.has_extended_error || report.extended_error.ee_origin != SO_EE_ORIGIN_ZEROCOPY
+           || report.extended_error.ee_errno != 0)
+        {
+            continue;
+        }
+
+        zerocopy_completion completion;
+        completion.first  = report.extended_error.ee_info;
+        completion.last   = report.extended_error.ee_data;
+        completion.copied = (report.extended_error.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0;
+        return completion;
+    }
+#else
+    return make_unexpected<error>(error_code::socket_recv_error, 0);
+#endif
+}
+
+expected<tx_timestamp, error> socket::poll_tx_timestamp() const noexcept
+{
+#ifdef __linux__
+    for(;;)
+    {
+        error_queue_report report;
+
+        const error read_error = read_error_queue(handle_m, report);
+        if(read_error != error_code::none)
+            return make_unexpected<error>(read_error);
+
+        // Not a timestamp - the error queue holds other reports too, skip it.
+        if(!report.has_extended_error || !report.has_timestamp
+           || report.extended_error.ee_origin != SO_EE_ORIGIN_TIMESTAMPING)
+        {
+            continue;
+        }
+
+        tx_timestamp timestamp;
+        timestamp.id        = report.extended_error.ee_data;
+        timestamp.stage     = report.extended_error.ee_info == SCM_TSTAMP_SCHED
+                                  ? tx_timestamp_stage::scheduled
+                                  : tx_timestamp_stage::sent;
+        timestamp.timestamp = to_time_point(report.timestamp);
+        return timestamp;
+    }
+#else
+    return make_unexpected<error>(error_code::socket_recv_error, 0);
+#endif
+}
+
 expected<packet, error> socket::recv(std::span<char> buffer) const noexcept
 {
-    union
+    native_address address;
+    socklen_t      address_length = native_address_length(protocol_m);
+
+#ifdef __linux__
+    if(receives_control_messages(flags_m))
     {
-        ::sockaddr_in  address_ipv4;
-        ::sockaddr_in6 address_ipv6;
-    };
+        ::iovec vector;
+        vector.iov_base = buffer.data();
+        vector.iov_len  = buffer.size();
 
-    sockaddr* address;
-    socklen_t address_length;
-    if(protocol_m == socket_protocol::ipv6)
+        alignas(::cmsghdr) char control[control_buffer_size];
+
+        ::msghdr message       = {};
+        message.msg_name       = connected_m ? nullptr : &address;
+        message.msg_namelen    = connected_m ? 0 : address_length;
+        message.msg_iov        = &vector;
+        message.msg_iovlen     = 1;
+        message.msg_control    = control;
+        message.msg_controllen = sizeof(control);
+
+        const ssize_t return_value = ::recvmsg(handle_m, &message, recv_flags);
+        if(return_value < 0)
+            return make_unexpected<error>(last_recv_error());
+
+        packet incoming = received_packet(connected_m ? peer_m
+                                                      : from_native_address(protocol_m, address),
+                                          buffer,
+                                          static_cast<size_t>(return_value));
+        read_control_messages(message, incoming);
+
+        return incoming;
+    }
+#endif
+
+    // Connected sockets only receive from the peer, so there's no address to read back.
+    if(connected_m)
     {
-        address        = (sockaddr*)&address_ipv6;
-        address_length = sizeof(address_ipv6);
+        const auto return_value =
+            ::recv(handle_m, (char*)buffer.data(), buffer.size(), recv_flags);
+        if(return_value >= 0)
+            return received_packet(peer_m, buffer, static_cast<size_t>(return_value));
     }
     else
     {
-        address        = (sockaddr*)&address_ipv4;
-        address_length = sizeof(address_ipv4);
+        const auto return_value = recvfrom(handle_m,
+                                           (char*)buffer.data(),
+                                           buffer.size(),
+                                           recv_flags,
+                                           &address.generic,
+                                           &address_length);
+        if(return_value >= 0)
+        {
+            return received_packet(
+                from_native_address(protocol_m, address), buffer, static_cast<size_t>(return_value));
+        }
+    }
+
+#ifdef WIN32
+    // Winsock fills the buffer with as much of a truncated datagram as fits, but reports an error,
+    // without the full size of the datagram.
+    if(detail::get_socket_api_error() == WSAEMSGSIZE)
+    {
+        packet incoming{connected_m ? peer_m : from_native_address(protocol_m, address), buffer};
+        incoming.truncated = true;
+        return incoming;
+    }
+#endif
+
+    return make_unexpected<error>(last_recv_error());
+}
+
+expected<packet, error> socket::recv(std::span<const std::span<char>> buffers) const noexcept
+{
+    if(buffers.size() > max_buffer_count)
+        return make_unexpected<error>(error_code::socket_recv_error, EINVAL);
+
+    const std::span<char> first = buffers.empty() ? std::span<char>{} : buffers.front();
+
+    size_t capacity = 0;
+    for(const std::span<char> buffer : buffers)
+        capacity += buffer.size();
+
+    native_address address;
+    socklen_t      address_length = native_address_length(protocol_m);
+
+#ifdef WIN32
+    WSABUF vectors[max_buffer_count];
+    for(size_t i = 0; i < buffers.size(); ++i)
+    {
+        vectors[i].buf = buffers[i].data();
+        vectors[i].len = static_cast<ULONG>(buffers[i].size());
+    }
+
+    DWORD received  = 0;
+    DWORD flags     = 0;
+    bool  truncated = false;
+    if(::WSARecvFrom(handle_m,
+                     vectors,
+                     static_cast<DWORD>(buffers.size()),
+                     &received,
+                     &flags,
+                     connected_m ? nullptr : &address.generic,
+                     connected_m ? nullptr : &address_length,
+                     nullptr,
+                     nullptr)
+       == detail::api_socket_error)
+    {
+        // Winsock fills the buffers with as much of a truncated datagram as fits, but reports an
+        // error, without the full size of the datagram.
+        if(detail::get_socket_api_error() != WSAEMSGSIZE)
+            return make_unexpected<error>(last_recv_error());
+
+        received  = static_cast<DWORD>(capacity);
+        truncated = true;
+    }
+
+    const size_t size = received;
+#else
+    ::iovec vectors[max_buffer_count];
+    for(size_t i = 0; i < buffers.size(); ++i)
+    {
+        vectors[i].iov_base = buffers[i].data();
+        vectors[i].iov_len  = buffers[i].size();
     }
 
-    int return_value =
-        recvfrom(handle_m, (char*)buffer.data(), buffer.size(), 0, address, &address_length);
+    ::msghdr message    = {};
+    message.msg_name    = connected_m ? nullptr : &address;
+    message.msg_namelen = connected_m ? 0 : address_length;
+    message.msg_iov     = vectors;
+    message.msg_iovlen  = buffers.size();
 
+#ifdef __linux__
+    alignas(::cmsghdr) char control[control_buffer_size];
+    if(receives_control_messages(flags_m))
+    {
+        message.msg_control    = control;
+        message.msg_controllen = sizeof(control);
+    }
+#endif
+
+    const ssize_t return_value = ::recvmsg(handle_m, &message, recv_flags);
+    if(return_value < 0)
+        return make_unexpected<error>(last_recv_error());
+
+    // Where the full size isn't reported, truncation is still flagged by the kernel.
+    const size_t size      = static_cast<size_t>(return_value);
+    const bool   truncated = size > capacity || (message.msg_flags & MSG_TRUNC) != 0;
+#endif
+
+    // Connected sockets only receive from the peer, so there's no address to read back.
+    packet incoming = received_packet(
+        connected_m ? peer_m : from_native_address(protocol_m, address), first, size);
+    incoming.truncated = truncated;
+
+#ifdef __linux__
+    read_control_messages(message, incoming);
+#endif
+
+    return incoming;
+}
+
+expected<size_t, error> socket::peek_size() const noexcept
+{
+#ifdef __linux__
+    // Peeking with MSG_TRUNC reports the full size without copying any of the datagram.
+    const auto return_value = ::recv(handle_m, nullptr, 0, MSG_PEEK | MSG_TRUNC);
+    if(return_value < 0)
+        return make_unexpected<error>(last_recv_error());
+
+    return static_cast<size_t>(return_value);
+#else
+    // Elsewhere, the size of the next datagram can only be asked for, and an empty queue can't be
+    // told apart from an empty datagram. macOS has SO_NREAD for it, while FIONREAD reports all the
+    // queued bytes on Windows and the BSDs, which is only an upper bound.
+#if defined(WIN32)
+    u_long size = 0;
+    if(::ioctlsocket(handle_m, FIONREAD, &size) == detail::api_socket_error)
+#elif defined(SO_NREAD)
+    int       size      = 0;
+    socklen_t size_size = sizeof(size);
+    if(::getsockopt(handle_m, SOL_SOCKET, SO_NREAD, &size, &size_size) == detail::api_socket_error)
+#else
+    int size = 0;
+    if(::ioctl(handle_m, FIONREAD, &size) == detail::api_socket_error)
+#endif
+        return make_unexpected<error>(error_code::socket_recv_error, detail::get_socket_api_error());
+
+    if(size == 0)
+        return make_unexpected<error>(error_code::socket_would_block, detail::api_error_would_block);
+
+    return static_cast<size_t>(size);
+#endif
+}
+
+expected<packet, error> socket::recv(std::span<char>  buffer,
+                                    socket_endpoint& source) const noexcept
+{
+    socklen_t source_size = sizeof(source.storage_m);
+    source.protocol_m     = protocol_m;
+
+#ifdef __linux__
+    if(receives_control_messages(flags_m))
+    {
+        ::iovec vector;
+        vector.iov_base = buffer.data();
+        vector.iov_len  = buffer.size();
+
+        alignas(::cmsghdr) char control[control_buffer_size];
+
+        ::msghdr message       = {};
+        message.msg_name       = source.storage_m;
+        message.msg_namelen    = source_size;
+        message.msg_iov        = &vector;
+        message.msg_iovlen     = 1;
+        message.msg_control    = control;
+        message.msg_controllen = sizeof(control);
+
+        const ssize_t return_value = ::recvmsg(handle_m, &message, recv_flags);
+        if(return_value < 0)
+            return make_unexpected<error>(last_recv_error());
+
+        source.size_m = static_cast<uint32_t>(message.msg_namelen);
+
+        packet incoming =
+            received_packet(socket_address{}, buffer, static_cast<size_t>(return_value));
+        read_control_messages(message, incoming);
+
+        return incoming;
+    }
+#endif
+
+    const auto return_value = ::recvfrom(handle_m,
+                                         (char*)buffer.data(),
+                                         buffer.size(),
+                                         recv_flags,
+                                         (::sockaddr*)source.storage_m,
+                                         &source_size);
     if(return_value >= 0)
     {
-        socket_address incoming_address =
-            protocol_m == socket_protocol::ipv6 ?
-                socket_address{
-                    std::span{(uint8_t*)&address_ipv6.sin6_addr, sizeof(address_ipv6.sin6_addr)},
-                    ntohs(address_ipv6.sin6_port)} :
-                socket_address{ntohl(address_ipv4.sin_addr.s_addr), ntohs(address_ipv4.sin_port)};
+        source.size_m = static_cast<uint32_t>(source_size);
+        return received_packet(socket_address{}, buffer, static_cast<size_t>(return_value));
+    }
 
-        const size_t incoming_size = static_cast<size_t>(return_value);
+#ifdef WIN32
+    // Winsock fills the buffer with as much of a truncated datagram as fits, but reports an error,
+    // without the full size of the datagram.
+    if(detail::get_socket_api_error() == WSAEMSGSIZE)
+    {
+        source.size_m = static_cast<uint32_t>(source_size);
 
-        return packet{incoming_address, std::span<char>{buffer.data(), incoming_size}};
+        packet incoming{socket_address{}, buffer};
+        incoming.truncated = true;
+        return incoming;
     }
-    else
+#endif
+
+    return make_unexpected<error>(last_recv_error());
+}
+
+expected<packet, error> socket::recv_for(std::span<char>           buffer,
+                                         std::chrono::milliseconds timeout) const noexcept
+{
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    for(;;)
+    {
+        auto result = recv(buffer);
+        if(result || result.error() != error_code::socket_would_block)
+            return result;
+
+        int wait = -1;
+        if(timeout.count() >= 0)
+        {
+            const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now());
+            if(remaining.count() <= 0)
+                return result;
+
+            wait = static_cast<int>(std::min<int64_t>(remaining.count(), INT_MAX));
+        }
+
+#ifdef WIN32
+        WSAPOLLFD descriptor = {};
+        descriptor.fd        = handle_m;
+        descriptor.events    = POLLRDNORM;
+
+        const int ready = ::WSAPoll(&descriptor, 1, wait);
+#else
+        ::pollfd descriptor = {};
+        descriptor.fd       = handle_m;
+        descriptor.events   = POLLIN;
+
+        const int ready = ::poll(&descriptor, 1, wait);
+#endif
+
+        if(ready == detail::api_socket_error)
+        {
+            const auto api_error = detail::get_socket_api_error();
+            if(api_error != EINTR)
+                return make_unexpected<error>(error_code::socket_recv_error, api_error);
+        }
+    }
+}
+
+expected<packet, error> socket::recv_adaptive(std::span<char>           buffer,
+                                              spin_wait&                wait,
+                                              std::chrono::milliseconds timeout) const noexcept
+{
+    // Shortest spin a wait grows from, once a packet arrives while spinning.
+    constexpr std::chrono::nanoseconds min_spin = std::chrono::microseconds{1};
+
+    const auto start         = std::chrono::steady_clock::now();
+    const auto spin_deadline = start + wait.spin;
+
+    for(;;)
+    {
+        auto result = recv(buffer);
+        if(result || result.error() != error_code::socket_would_block)
+        {
+            // Packets arrive within spins - keep spinning for longer.
+            wait.spin = std::min(wait.max_spin, std::max(min_spin, wait.spin * 2));
+            return result;
+        }
+
+        if(std::chrono::steady_clock::now() >= spin_deadline)
+            break;
+    }
+
+    // Nothing arrived while spinning - spin for less next time, and go to sleep.
+    wait.spin /= 2;
+
+    if(timeout.count() < 0)
+        return recv_for(buffer, timeout);
+
+    const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+        start + timeout - std::chrono::steady_clock::now());
+    return recv_for(buffer, std::max(remaining, std::chrono::milliseconds{0}));
+}
+
+expected<std::span<packet>, error> socket::recv_batch(std::span<const std::span<char>> buffers,
+                                                      std::span<packet> packets) const noexcept
+{
+    const size_t count = std::min({buffers.size(), packets.size(), max_batch_size});
+    if(count == 0)
+        return packets.first(0);
+
+#ifdef __linux__
+    ::mmsghdr      messages[max_batch_size];
+    ::iovec        vectors[max_batch_size];
+    native_address addresses[max_batch_size];
+
+    // Control buffers are only used if the socket receives ancillary data.
+    const bool              control = receives_control_messages(flags_m);
+    alignas(::cmsghdr) char controls[max_batch_size][control_buffer_size];
+
+    for(size_t i = 0; i < count; ++i)
+    {
+        vectors[i].iov_base = buffers[i].data();
+        vectors[i].iov_len  = buffers[i].size();
+
+        messages[i]                     = {};
+        messages[i].msg_hdr.msg_name    = &addresses[i];
+        messages[i].msg_hdr.msg_namelen = native_address_length(protocol_m);
+        messages[i].msg_hdr.msg_iov     = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen  = 1;
+
+        if(control)
+        {
+            messages[i].msg_hdr.msg_control    = controls[i];
+            messages[i].msg_hdr.msg_controllen = control_buffer_size;
+        }
+    }
+
+    const int received = ::recvmmsg(handle_m, messages, count, recv_flags, nullptr);
+    if(received < 0)
+        return make_unexpected<error>(last_recv_error());
+
+    for(size_t i = 0; i < static_cast<size_t>(received); ++i)
+    {
+        packets[i] = received_packet(
+            from_native_address(protocol_m, addresses[i]), buffers[i], messages[i].msg_len);
+
+        if(control)
+            read_control_messages(messages[i].msg_hdr, packets[i]);
+    }
+
+    return packets.first(received);
+#else
+    // No batched receive available - fall back to receiving one packet at a time.
+    size_t received = 0;
+    for(; received < count; ++received)
     {
-        const auto api_error = detail::get_socket_api_error();
-        if(api_error == detail::api_error_would_block)
-            return make_unexpected<error>(error_code::socket_would_block, api_error);
+        auto result = recv(buffers[received]);
+        if(!result)
+        {
+            if(received == 0)
+                return make_unexpected<error>(result.error());
+
+            break;
+        }
 
-        return make_unexpected<error>(error_code::socket_recv_error, api_error);
+        packets[received] = *result;
     }
+
+    return packets.first(received);
+#endif
 }
 
 } // namespace wadjet
\ No newline at end of file
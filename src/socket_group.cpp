@@ -0,0 +1,234 @@
+#include <wadjet/socket_group.hpp>
+
+#include <wadjet/detail/posix.hpp>
+
+#ifdef __linux__
+#include <linux/filter.h>
+#include <sched.h>
+#endif
+
+#include <cassert>
+#include <cerrno>
+#include <iterator>
+
+namespace wadjet {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Socket group member implementation.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+socket_group::member::member(socket_protocol protocol, socket_flags flags, size_t index) :
+    socket_m(protocol, flags),
+    index_m(index),
+    packets_received_m(0),
+    bytes_received_m(0),
+    packets_sent_m(0),
+    bytes_sent_m(0)
+{
+}
+
+size_t socket_group::member::index() const noexcept
+{
+    return index_m;
+}
+
+const socket& socket_group::member::socket() const noexcept
+{
+    return socket_m;
+}
+
+error socket_group::member::send(socket_address address, std::span<const char> buffer) noexcept
+{
+    const error result = socket_m.send(address, buffer);
+    if(result == error_code::none)
+    {
+        packets_sent_m.fetch_add(1, std::memory_order_relaxed);
+        bytes_sent_m.fetch_add(buffer.size(), std::memory_order_relaxed);
+    }
+
+    return result;
+}
+
+expected<packet, error> socket_group::member::recv(std::span<char> buffer) noexcept
+{
+    auto result = socket_m.recv(buffer);
+    if(result)
+        account_received(std::span{&*result, 1});
+
+    return result;
+}
+
+expected<packet, error> socket_group::member::recv_for(std::span<char>           buffer,
+                                                       std::chrono::milliseconds timeout) noexcept
+{
+    auto result = socket_m.recv_for(buffer, timeout);
+    if(result)
+        account_received(std::span{&*result, 1});
+
+    return result;
+}
+
+expected<std::span<packet>, error>
+socket_group::member::recv_batch(std::span<const std::span<char>> buffers,
+                                 std::span<packet>                packets) noexcept
+{
+    auto result = socket_m.recv_batch(buffers, packets);
+    if(result)
+        account_received(*result);
+
+    return result;
+}
+
+socket_group_stats socket_group::member::stats() const noexcept
+{
+    socket_group_stats stats;
+    stats.packets_received = packets_received_m.load(std::memory_order_relaxed);
+    stats.bytes_received   = bytes_received_m.load(std::memory_order_relaxed);
+    stats.packets_sent     = packets_sent_m.load(std::memory_order_relaxed);
+    stats.bytes_sent       = bytes_sent_m.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void socket_group::member::account_received(std::span<const packet> packets) noexcept
+{
+    uint64_t bytes = 0;
+    for(const packet& packet : packets)
+        bytes += packet.payload.size();
+
+    packets_received_m.fetch_add(packets.size(), std::memory_order_relaxed);
+    bytes_received_m.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Socket group implementation.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+socket_group::socket_group(socket_protocol protocol,
+                           socket_flags    flags,
+                           socket_address  address,
+                           size_t          size) :
+    address_m(address)
+{
+    members_m.reserve(size);
+    for(size_t i = 0; i < size; ++i)
+    {
+        auto new_member = std::make_unique<member>(protocol, flags | socket_flags::reuse_port, i);
+
+        auto bind_error = new_member->socket().bind(address_m);
+        if(bind_error != error_code::none)
+            throw exception{bind_error};
+
+        // Once the first member picks a port, the rest of the group must follow.
+        if(i == 0)
+        {
+            auto bound_address = new_member->socket().address();
+            if(!bound_address)
+                throw exception{bound_address.error()};
+
+            address_m = *bound_address;
+        }
+
+        members_m.push_back(std::move(new_member));
+    }
+}
+
+size_t socket_group::size() const noexcept
+{
+    return members_m.size();
+}
+
+socket_address socket_group::address() const noexcept
+{
+    return address_m;
+}
+
+socket_group::member& socket_group::operator[](size_t index) noexcept
+{
+    assert(index < members_m.size());
+    return *members_m[index];
+}
+
+const socket_group::member& socket_group::operator[](size_t index) const noexcept
+{
+    assert(index < members_m.size());
+    return *members_m[index];
+}
+
+error socket_group::steer_by_cpu() const noexcept
+{
+#ifdef __linux__
+    if(members_m.empty())
+        return error::success();
+
+    // Selects the member by the index of the CPU processing the packet, modulo the group size.
+    ::sock_filter instructions[] = {
+        {BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)},
+        {BPF_ALU | BPF_MOD | BPF_K, 0, 0, static_cast<uint32_t>(members_m.size())},
+        {BPF_RET | BPF_A, 0, 0, 0},
+    };
+
+    ::sock_fprog program;
+    program.len    = static_cast<unsigned short>(std::size(instructions));
+    program.filter = instructions;
+
+    // The program is shared by the whole reuseport group, so attaching it to one member is enough.
+    const socket::handle_t handle = members_m.front()->socket().native_handle();
+    if(::setsockopt(handle, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program, sizeof(program))
+       == detail::api_socket_error)
+    {
+        return error{error_code::socket_option_unavailable, detail::get_socket_api_error()};
+    }
+
+    // Also record the CPU each member serves, so that incoming_cpu preference agrees with the
+    // program.
+    for(const auto& member : members_m)
+    {
+        auto cpu_error = member->socket().set_incoming_cpu(static_cast<int>(member->index()));
+        if(cpu_error != error_code::none)
+            return cpu_error;
+    }
+
+    return error::success();
+#else
+    return error{error_code::socket_option_unavailable, 0};
+#endif
+}
+
+expected<size_t, error> socket_group::pin_current_thread(int cpu) const noexcept
+{
+#ifdef __linux__
+    if(cpu < 0 || cpu >= CPU_SETSIZE || members_m.empty())
+        return make_unexpected<error>(error_code::thread_affinity_fail, EINVAL);
+
+    ::cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+
+    // Zero stands for the calling thread.
+    if(::sched_setaffinity(0, sizeof(cpus), &cpus) != 0)
+        return make_unexpected<error>(error_code::thread_affinity_fail, errno);
+
+    return static_cast<size_t>(cpu) % members_m.size();
+#else
+    (void)cpu;
+    return make_unexpected<error>(error_code::thread_affinity_fail, 0);
+#endif
+}
+
+socket_group_stats socket_group::stats() const noexcept
+{
+    socket_group_stats total;
+    for(const auto& member : members_m)
+    {
+        const socket_group_stats stats = member->stats();
+
+        total.packets_received += stats.packets_received;
+        total.bytes_received += stats.bytes_received;
+        total.packets_sent += stats.packets_sent;
+        total.bytes_sent += stats.bytes_sent;
+    }
+
+    return total;
+}
+
+} // namespace wadjet
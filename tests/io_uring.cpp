@@ -0,0 +1,311 @@
+#ifdef WADJET_IO_URING
+
+#include "catch_amalgamated.hpp"
+
+#include <wadjet/io_uring.hpp>
+
+#include <array>
+#include <cstring>
+#include <string_view>
+
+using namespace wadjet;
+
+TEST_CASE("io_uring engine send and receive", "[io_uring]")
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{socket_protocol::ipv4, socket_flags::none};
+    socket receiver = socket{socket_protocol::ipv4, socket_flags::none};
+
+    REQUIRE(receiver.bind(socket_address::any(socket_protocol::ipv4)) == error_code::none);
+    auto receiver_address = receiver.address();
+    REQUIRE(receiver_address);
+
+    auto address =
+        socket_address::loopback(socket_protocol::ipv4, receiver_address->port_host_order());
+
+    std::array<std::array<char, 64>, 2> storage;
+    std::array<std::span<char>, 2>      buffers = {std::span{storage[0]}, std::span{storage[1]}};
+
+    io_uring_engine engine{8, 2, buffers};
+
+    auto sender_index = engine.register_socket(sender);
+    REQUIRE(sender_index);
+    auto receiver_index = engine.register_socket(receiver);
+    REQUIRE(receiver_index);
+
+    constexpr std::string_view message = "hello there";
+    std::memcpy(engine.buffer(0).data(), message.data(), message.size());
+
+    // Queue the receive first - it completes once the send lands.
+    REQUIRE(engine.prepare_recv(*receiver_index, 1, 2) == error_code::none);
+    REQUIRE(engine.prepare_send(*sender_index, address, 0, message.size(), 1) == error_code::none);
+
+    auto submitted = engine.submit(2);
+    REQUIRE(submitted);
+    CHECK(*submitted == 2);
+
+    size_t completed = 0;
+    while(completed < 2)
+    {
+        auto completion = engine.poll_completion();
+        if(!completion)
+        {
+            REQUIRE(engine.submit(1));
+            continue;
+        }
+
+        REQUIRE(completion->result == error_code::none);
+        CHECK(completion->payload.size() == message.size());
+
+        if(completion->operation == io_operation::recv)
+        {
+            CHECK(completion->user_data == 2);
+            CHECK(completion->buffer_index == 1);
+            CHECK(std::string_view{completion->payload.data(), completion->payload.size()}
+                  == message);
+        }
+        else
+        {
+            CHECK(completion->user_data == 1);
+        }
+
+        ++completed;
+    }
+
+    CHECK(!engine.poll_completion());
+    CHECK(engine.unregister_socket(*sender_index) == error_code::none);
+}
+
+TEST_CASE("io_uring engine zero-copy send", "[io_uring]")
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{socket_protocol::ipv4, socket_flags::none};
+    socket receiver = socket{socket_protocol::ipv4, socket_flags::none};
+
+    REQUIRE(receiver.bind(socket_address::any(socket_protocol::ipv4)) == error_code::none);
+    auto receiver_address = receiver.address();
+    REQUIRE(receiver_address);
+
+    auto address =
+        socket_address::loopback(socket_protocol::ipv4, receiver_address->port_host_order());
+
+    std::array<char, 64>           storage;
+    std::array<std::span<char>, 1> buffers = {std::span{storage}};
+
+    io_uring_engine engine{8, 1, buffers};
+
+    auto sender_index = engine.register_socket(sender);
+    REQUIRE(sender_index);
+
+    // Zero-copy sends require a fairly recent kernel.
+    const error zero_copy_error = engine.set_zero_copy_threshold(0);
+    if(zero_copy_error != error_code::none)
+    {
+        WARN("zero-copy sends unsupported, underlying error: " << zero_copy_error.underlying_code);
+        return;
+    }
+
+    constexpr std::string_view message = "hello there";
+    std::memcpy(engine.buffer(0).data(), message.data(), message.size());
+
+    REQUIRE(engine.prepare_send(*sender_index, address, 0, message.size(), 1) == error_code::none);
+    REQUIRE(engine.submit());
+
+    // Only a single completion is reported, once the kernel is done with the buffer.
+    auto completion = engine.poll_completion();
+    while(!completion)
+    {
+        REQUIRE(engine.submit(1));
+        if(auto next = engine.poll_completion())
+            completion.emplace(*next);
+    }
+
+    REQUIRE(completion->result == error_code::none);
+    CHECK(completion->operation == io_operation::send);
+    CHECK(completion->user_data == 1);
+    CHECK(completion->payload.size() == message.size());
+    CHECK(!engine.poll_completion());
+
+    std::array<char, 64> recv_buffer;
+
+    auto result = receiver.recv_for(std::span{recv_buffer}, std::chrono::milliseconds{1000});
+    REQUIRE(result);
+    CHECK(std::string_view{result->payload.data(), result->payload.size()} == message);
+}
+
+TEST_CASE("io_uring engine multishot receive", "[io_uring]")
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{socket_protocol::ipv4, socket_flags::none};
+    socket receiver = socket{socket_protocol::ipv4, socket_flags::none};
+
+    REQUIRE(receiver.bind(socket_address::any(socket_protocol::ipv4)) == error_code::none);
+    auto receiver_address = receiver.address();
+    REQUIRE(receiver_address);
+
+    auto address =
+        socket_address::loopback(socket_protocol::ipv4, receiver_address->port_host_order());
+
+    io_uring_engine engine{8, 1, {}};
+
+    auto receiver_index = engine.register_socket(receiver);
+    REQUIRE(receiver_index);
+
+    // Provided buffer rings require a fairly recent kernel.
+    const error pool_error = engine.create_buffer_pool(4, 256);
+    if(pool_error != error_code::none)
+    {
+        WARN("buffer pools unsupported, underlying error: " << pool_error.underlying_code);
+        return;
+    }
+
+    REQUIRE(engine.prepare_multishot_recv(*receiver_index, 7) == error_code::none);
+    REQUIRE(engine.submit());
+
+    // More packets than there are buffers, so buffers must be recycled along the way.
+    constexpr std::array<std::string_view, 6> messages = {"a", "bb", "ccc", "dddd", "eeeee", "f"};
+    for(const auto message : messages)
+    {
+        REQUIRE(sender.send(address, std::span{message}) == error_code::none);
+
+        auto submitted = engine.submit(1);
+        REQUIRE(submitted);
+
+        auto completion = engine.poll_completion();
+        REQUIRE(completion);
+        REQUIRE(completion->result == error_code::none);
+        CHECK(completion->operation == io_operation::multishot_recv);
+        CHECK(completion->user_data == 7);
+        CHECK(completion->active);
+        CHECK(completion->address.port_host_order() == sender.address()->port_host_order());
+        CHECK(std::string_view{completion->payload.data(), completion->payload.size()} == message);
+        CHECK(!completion->truncated);
+
+        engine.recycle_buffer(completion->buffer_index);
+    }
+
+    // Packets larger than a pool buffer are cut short.
+    const std::array<char, 512> oversized = {};
+    REQUIRE(sender.send(address, std::span{oversized}) == error_code::none);
+    REQUIRE(engine.submit(1));
+
+    auto oversized_completion = engine.poll_completion();
+    REQUIRE(oversized_completion);
+    REQUIRE(oversized_completion->result == error_code::none);
+    CHECK(oversized_completion->truncated);
+    CHECK(oversized_completion->payload.size() < oversized.size());
+
+    engine.recycle_buffer(oversized_completion->buffer_index);
+
+    // Cancelling produces two completions - one for the cancellation, and a final one for the
+    // multishot receive.
+    REQUIRE(engine.prepare_cancel(7) == error_code::none);
+    REQUIRE(engine.submit(2));
+
+    bool cancelled = false;
+    bool finished  = false;
+    while(auto completion = engine.poll_completion())
+    {
+        if(completion->operation == io_operation::cancel)
+        {
+            CHECK(completion->result == error_code::none);
+            CHECK(completion->buffer_index == io_completion::no_buffer);
+            cancelled = true;
+        }
+        else
+        {
+            CHECK(completion->operation == io_operation::multishot_recv);
+            CHECK(!completion->active);
+            CHECK(completion->buffer_index == io_completion::no_buffer);
+            finished = true;
+        }
+    }
+
+    CHECK(cancelled);
+    CHECK(finished);
+}
+
+TEST_CASE("io_uring engine multishot receive overflow", "[io_uring]")
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{socket_protocol::ipv4, socket_flags::none};
+    socket receiver = socket{socket_protocol::ipv4, socket_flags::none};
+
+    REQUIRE(receiver.bind(socket_address::any(socket_protocol::ipv4)) == error_code::none);
+    auto receiver_address = receiver.address();
+    REQUIRE(receiver_address);
+
+    auto address =
+        socket_address::loopback(socket_protocol::ipv4, receiver_address->port_host_order());
+
+    // The smallest queue, whose completion queue is far outnumbered by the received packets.
+    io_uring_engine engine{1, 1, {}};
+
+    auto receiver_index = engine.register_socket(receiver);
+    REQUIRE(receiver_index);
+
+    const error pool_error = engine.create_buffer_pool(32, 256);
+    if(pool_error != error_code::none)
+    {
+        WARN("buffer pools unsupported, underlying error: " << pool_error.underlying_code);
+        return;
+    }
+
+    REQUIRE(engine.prepare_multishot_recv(*receiver_index, 7) == error_code::none);
+    REQUIRE(engine.submit());
+
+    constexpr size_t packet_count = 16;
+    for(size_t i = 0; i < packet_count; ++i)
+    {
+        const char payload = static_cast<char>(i);
+        REQUIRE(sender.send(address, std::span{&payload, 1}) == error_code::none);
+    }
+
+    // Once the completion queue fills up, the kernel ends the receive, with a final completion
+    // which overflows. It's still reported, without having to wait for it.
+    REQUIRE(engine.submit(1));
+
+    size_t received = 0;
+    bool   active   = true;
+    while(active)
+    {
+        auto completion = engine.poll_completion();
+        REQUIRE(completion);
+        REQUIRE(completion->result == error_code::none);
+        REQUIRE(completion->payload.size() == 1);
+        CHECK(completion->payload[0] == static_cast<char>(received++));
+
+        active = completion->active;
+        engine.recycle_buffer(completion->buffer_index);
+    }
+
+    // The packets which weren't received yet are picked up by a new receive.
+    REQUIRE(engine.prepare_multishot_recv(*receiver_index, 8) == error_code::none);
+    REQUIRE(engine.submit());
+
+    while(received < packet_count)
+    {
+        auto completion = engine.poll_completion();
+        if(!completion)
+        {
+            REQUIRE(engine.submit(1));
+            continue;
+        }
+
+        REQUIRE(completion->payload.size() == 1);
+        CHECK(completion->payload[0] == static_cast<char>(received++));
+
+        engine.recycle_buffer(completion->buffer_index);
+        if(!completion->active)
+        {
+            REQUIRE(engine.prepare_multishot_recv(*receiver_index, 8) == error_code::none);
+            REQUIRE(engine.submit());
+        }
+    }
+}
+
+#endif
@@ -2,6 +2,7 @@
 #include "catch_amalgamated.hpp"
 
 #include <wadjet/socket.hpp>
+#include <algorithm>
 #include <array>
 #include <cstring>
 
@@ -107,3 +108,871 @@ TEST_CASE("socket IPV6 -> IPV6 send and receive", "[socket]")
                                  socket_protocol::ipv6,
                                  socket_flags::dual_stack | socket_flags::none);
 }
+
+void test_batch_receive(socket_protocol protocol, socket_flags flags)
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{protocol, flags};
+    socket receiver = socket{protocol, flags};
+
+    REQUIRE(receiver.bind(socket_address::any(protocol)) == error_code::none);
+    auto receiver_address = receiver.address();
+    REQUIRE(receiver_address);
+
+    auto address = socket_address::loopback(protocol, receiver_address->port_host_order());
+
+    // Send fewer messages than there are buffers, so the batch comes back partially filled.
+    constexpr std::array<std::string_view, 3> messages = {"first", "second", "third"};
+    for(const auto message : messages)
+        REQUIRE(sender.send(address, std::span{message}) == error_code::none);
+
+    std::array<std::array<char, 64>, 4> storage;
+    std::array<std::span<char>, 4>      buffers;
+    for(size_t i = 0; i < buffers.size(); ++i)
+        buffers[i] = std::span{storage[i]};
+
+    std::array<packet, 4> packets;
+
+    auto result = receiver.recv_batch(buffers, packets);
+    REQUIRE(result);
+    REQUIRE(result->size() == messages.size());
+
+    for(size_t i = 0; i < messages.size(); ++i)
+    {
+        const auto& payload = (*result)[i].payload;
+        CHECK(std::string_view{payload.data(), payload.size()} == messages[i]);
+        CHECK((*result)[i].address.port_host_order() == sender.address()->port_host_order());
+    }
+
+    // Queue is now drained.
+    auto empty_result = receiver.recv_batch(buffers, packets);
+    REQUIRE(!empty_result);
+    CHECK(empty_result.error() == error_code::socket_would_block);
+}
+
+TEST_CASE("socket IPV4 batch receive", "[socket]")
+{
+    test_batch_receive(socket_protocol::ipv4, socket_flags::none);
+}
+
+TEST_CASE("socket IPV6 batch receive", "[socket]")
+{
+    test_batch_receive(socket_protocol::ipv6, socket_flags::dual_stack);
+}
+
+void test_batch_send(socket_protocol protocol, socket_flags flags)
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{protocol, flags};
+    socket receiver = socket{protocol, flags};
+
+    REQUIRE(receiver.bind(socket_address::any(protocol)) == error_code::none);
+    auto receiver_address = receiver.address();
+    REQUIRE(receiver_address);
+
+    auto address = socket_address::loopback(protocol, receiver_address->port_host_order());
+
+    constexpr std::array<std::string_view, 3> messages = {"first", "second", "third"};
+
+    std::array<outgoing_packet, messages.size()> outgoing;
+    for(size_t i = 0; i < messages.size(); ++i)
+        outgoing[i] = outgoing_packet{address, std::span{messages[i]}};
+
+    auto sent = sender.send_batch(outgoing);
+    REQUIRE(sent);
+    REQUIRE(*sent == messages.size());
+
+    std::array<char, 64> recv_buffer;
+    for(const auto message : messages)
+    {
+        auto result = receiver.recv(std::span{recv_buffer});
+        REQUIRE(result);
+        CHECK(std::string_view{result->payload.data(), result->payload.size()} == message);
+    }
+}
+
+TEST_CASE("socket IPV4 batch send", "[socket]")
+{
+    test_batch_send(socket_protocol::ipv4, socket_flags::none);
+}
+
+TEST_CASE("socket IPV6 batch send", "[socket]")
+{
+    test_batch_send(socket_protocol::ipv6, socket_flags::dual_stack);
+}
+
+void test_segmented_send(socket_protocol protocol, socket_flags flags)
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{protocol, flags};
+    socket receiver = socket{protocol, flags};
+
+    REQUIRE(receiver.bind(socket_address::any(protocol)) == error_code::none);
+    auto receiver_address = receiver.address();
+    REQUIRE(receiver_address);
+
+    auto address = socket_address::loopback(protocol, receiver_address->port_host_order());
+
+    // The last segment is intentionally shorter than the others.
+    constexpr size_t       segment_size = 1000;
+    std::array<char, 2500> send_buffer;
+    for(size_t i = 0; i < send_buffer.size(); ++i)
+        send_buffer[i] = static_cast<char>(i);
+
+    auto sent = sender.send_segmented(address, std::span{send_buffer}, segment_size);
+    REQUIRE(sent);
+    REQUIRE(*sent == send_buffer.size());
+
+    std::array<char, 2 * segment_size> recv_buffer;
+    for(size_t offset = 0; offset < send_buffer.size(); offset += segment_size)
+    {
+        const size_t expected_size = std::min(segment_size, send_buffer.size() - offset);
+
+        auto result = receiver.recv(std::span{recv_buffer});
+        REQUIRE(result);
+        REQUIRE(result->payload.size() == expected_size);
+        CHECK(std::memcmp(result->payload.data(), send_buffer.data() + offset, expected_size) == 0);
+    }
+}
+
+TEST_CASE("socket IPV4 segmented send", "[socket]")
+{
+    test_segmented_send(socket_protocol::ipv4, socket_flags::none);
+}
+
+TEST_CASE("socket IPV6 segmented send", "[socket]")
+{
+    test_segmented_send(socket_protocol::ipv6, socket_flags::dual_stack);
+}
+
+#ifdef __linux__
+TEST_CASE("socket coalesced receive", "[socket]")
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{socket_protocol::ipv4, socket_flags::none};
+    socket receiver = socket{socket_protocol::ipv4, socket_flags::udp_gro};
+
+    REQUIRE(receiver.bind(socket_address::any(socket_protocol::ipv4)) == error_code::none);
+    auto receiver_address = receiver.address();
+    REQUIRE(receiver_address);
+
+    auto address =
+        socket_address::loopback(socket_protocol::ipv4, receiver_address->port_host_order());
+
+    constexpr size_t       segment_size = 1000;
+    std::array<char, 2500> send_buffer;
+    for(size_t i = 0; i < send_buffer.size(); ++i)
+        send_buffer[i] = static_cast<char>(i);
+
+    auto sent = sender.send_segmented(address, std::span{send_buffer}, segment_size);
+    REQUIRE(sent);
+    REQUIRE(*sent == send_buffer.size());
+
+    // Whether datagrams arrive coalesced is up to the kernel, but iterating over segments must
+    // always yield the original datagrams.
+    std::array<char, 65536> recv_buffer;
+
+    size_t offset = 0;
+    while(offset < send_buffer.size())
+    {
+        auto result = receiver.recv(std::span{recv_buffer});
+        REQUIRE(result);
+
+        for(const std::span<char> segment : result->segments())
+        {
+            const size_t expected_size = std::min(segment_size, send_buffer.size() - offset);
+
+            REQUIRE(segment.size() == expected_size);
+            CHECK(std::memcmp(segment.data(), send_buffer.data() + offset, expected_size) == 0);
+            offset += segment.size();
+        }
+    }
+
+    CHECK(offset == send_buffer.size());
+}
+#endif
+
+TEST_CASE("socket receive with timeout", "[socket]")
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{socket_protocol::ipv4, socket_flags::none};
+    socket receiver = socket{socket_protocol::ipv4, socket_flags::none};
+
+    REQUIRE(receiver.bind(socket_address::any(socket_protocol::ipv4)) == error_code::none);
+    auto receiver_address = receiver.address();
+    REQUIRE(receiver_address);
+
+    std::array<char, 64> recv_buffer;
+
+    // Nothing is waiting, so the timeout has to expire.
+    const auto start  = std::chrono::steady_clock::now();
+    auto       result = receiver.recv_for(std::span{recv_buffer}, std::chrono::milliseconds{20});
+    REQUIRE(!result);
+    CHECK(result.error() == error_code::socket_would_block);
+    CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds{20});
+
+    constexpr std::string_view message = "hello there";
+    auto address =
+        socket_address::loopback(socket_protocol::ipv4, receiver_address->port_host_order());
+    REQUIRE(sender.send(address, std::span{message}) == error_code::none);
+
+    auto received = receiver.recv_for(std::span{recv_buffer}, std::chrono::milliseconds{1000});
+    REQUIRE(received);
+    CHECK(std::string_view{received->payload.data(), received->payload.size()} == message);
+}
+
+#ifdef __linux__
+TEST_CASE("socket zero-copy send", "[socket]")
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{socket_protocol::ipv4, socket_flags::zerocopy};
+    socket receiver = socket{socket_protocol::ipv4, socket_flags::none};
+
+    REQUIRE(receiver.bind(socket_address::any(socket_protocol::ipv4)) == error_code::none);
+    auto receiver_address = receiver.address();
+    REQUIRE(receiver_address);
+
+    auto address =
+        socket_address::loopback(socket_protocol::ipv4, receiver_address->port_host_order());
+
+    std::array<char, 4096> send_buffer;
+    for(size_t i = 0; i < send_buffer.size(); ++i)
+        send_buffer[i] = static_cast<char>(i);
+
+    // IDs are assigned sequentially.
+    constexpr uint32_t send_count = 3;
+    for(uint32_t i = 0; i < send_count; ++i)
+    {
+        auto id = sender.send_zerocopy(address, std::span{send_buffer});
+        REQUIRE(id);
+        CHECK(*id == i);
+    }
+
+    std::array<char, 4096> recv_buffer;
+    for(uint32_t i = 0; i < send_count; ++i)
+    {
+        auto result = receiver.recv_for(std::span{recv_buffer}, std::chrono::milliseconds{1000});
+        REQUIRE(result);
+        REQUIRE(result->payload.size() == send_buffer.size());
+        CHECK(std::memcmp(result->payload.data(), send_buffer.data(), send_buffer.size()) == 0);
+    }
+
+    // Once delivered over loopback, every send has completed, though with the payload copied.
+    uint32_t completed = 0;
+    while(auto completion = sender.poll_zerocopy())
+    {
+        CHECK(completion->covers(completed));
+        CHECK(completion->copied);
+        completed = completion->last + 1;
+    }
+
+    CHECK(completed == send_count);
+
+    // Sockets without socket_flags::zerocopy can't send without copying.
+    socket plain = socket{socket_protocol::ipv4, socket_flags::none};
+    CHECK(!plain.send_zerocopy(address, std::span{send_buffer}));
+}
+#endif
+
+TEST_CASE("socket connected send and receive", "[socket]")
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{socket_protocol::ipv4, socket_flags::none};
+    socket receiver = socket{socket_protocol::ipv4, socket_flags::none};
+    socket stranger = socket{socket_protocol::ipv4, socket_flags::none};
+
+    REQUIRE(sender.bind(socket_address::loopback(socket_protocol::ipv4)) == error_code::none);
+    REQUIRE(receiver.bind(socket_address::loopback(socket_protocol::ipv4)) == error_code::none);
+
+    auto sender_address   = sender.address();
+    auto receiver_address = receiver.address();
+    REQUIRE(sender_address);
+    REQUIRE(receiver_address);
+
+    REQUIRE(sender.connect(*receiver_address) == error_code::none);
+    REQUIRE(receiver.connect(*sender_address) == error_code::none);
+
+    // Packets from anyone but the peer are filtered out.
+    constexpr std::string_view noise = "noise";
+    REQUIRE(stranger.send(*receiver_address, std::span{noise}) == error_code::none);
+
+    constexpr std::string_view message = "hello there";
+    REQUIRE(sender.send(std::span{message}) == error_code::none);
+
+    std::array<char, 64> recv_buffer;
+
+    auto result = receiver.recv_for(std::span{recv_buffer}, std::chrono::milliseconds{1000});
+    REQUIRE(result);
+    CHECK(std::string_view{result->payload.data(), result->payload.size()} == message);
+    CHECK(result->address.port_host_order() == sender_address->port_host_order());
+
+    auto nothing = receiver.recv(std::span{recv_buffer});
+    REQUIRE(!nothing);
+    CHECK(nothing.error() == error_code::socket_would_block);
+}
+
+TEST_CASE("socket endpoint send and receive", "[socket]")
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{socket_protocol::ipv6, socket_flags::dual_stack};
+    socket receiver = socket{socket_protocol::ipv4, socket_flags::none};
+
+    REQUIRE(receiver.bind(socket_address::loopback(socket_protocol::ipv4)) == error_code::none);
+    auto receiver_address = receiver.address();
+    REQUIRE(receiver_address);
+
+    // Dual-stack sockets reach IPV4 peers through mapped addresses.
+    const socket_endpoint destination{sender.protocol(), *receiver_address};
+    CHECK(destination.protocol() == socket_protocol::ipv6);
+    CHECK(destination.address().port_host_order() == receiver_address->port_host_order());
+
+    constexpr std::string_view message = "hello there";
+    REQUIRE(sender.send(destination, std::span{message}) == error_code::none);
+    REQUIRE(sender.send(destination, std::span{message}) == error_code::none);
+
+    std::array<char, 64> recv_buffer;
+
+    socket_endpoint first_source;
+    auto            first = receiver.recv(std::span{recv_buffer}, first_source);
+    REQUIRE(first);
+    CHECK(std::string_view{first->payload.data(), first->payload.size()} == message);
+    CHECK(!first->truncated);
+
+    socket_endpoint second_source;
+    auto            second = receiver.recv(std::span{recv_buffer}, second_source);
+    REQUIRE(second);
+
+    // Both packets came from the same place.
+    CHECK(first_source == second_source);
+
+    auto sender_address = sender.address();
+    REQUIRE(sender_address);
+    CHECK(first_source.protocol() == socket_protocol::ipv4);
+    CHECK(first_source.address().port_host_order() == sender_address->port_host_order());
+
+    const socket_endpoint expected_source{
+        socket_protocol::ipv4,
+        socket_address::loopback(socket_protocol::ipv4, sender_address->port_host_order())};
+    CHECK(first_source == expected_source);
+
+    // Replies go straight back to the received endpoint.
+    REQUIRE(receiver.send(first_source, std::span{message}) == error_code::none);
+
+    auto reply = sender.recv_for(std::span{recv_buffer}, std::chrono::milliseconds{1000});
+    REQUIRE(reply);
+    CHECK(std::string_view{reply->payload.data(), reply->payload.size()} == message);
+}
+
+#ifdef __linux__
+TEST_CASE("socket receive timestamps", "[socket]")
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{socket_protocol::ipv4, socket_flags::none};
+    socket receiver = socket{socket_protocol::ipv4, socket_flags::rx_timestamps};
+
+    REQUIRE(receiver.bind(socket_address::loopback(socket_protocol::ipv4)) == error_code::none);
+    auto receiver_address = receiver.address();
+    REQUIRE(receiver_address);
+
+    // Allow some slack, since the kernel clock may be read at a coarser granularity.
+    const auto before = std::chrono::system_clock::now() - std::chrono::milliseconds{10};
+
+    constexpr std::string_view message = "hello there";
+    REQUIRE(sender.send(*receiver_address, std::span{message}) == error_code::none);
+    REQUIRE(sender.send(*receiver_address, std::span{message}) == error_code::none);
+
+    std::array<char, 64> recv_buffer;
+
+    auto result = receiver.recv_for(std::span{recv_buffer}, std::chrono::milliseconds{1000});
+    REQUIRE(result);
+    CHECK(result->timestamp >= before);
+    CHECK(result->timestamp <= std::chrono::system_clock::now());
+
+    // Batched receives carry timestamps too.
+    std::array<std::array<char, 64>, 2> storage;
+    std::array<std::span<char>, 2>      buffers = {std::span{storage[0]}, std::span{storage[1]}};
+    std::array<packet, 2>               packets;
+
+    auto batch = receiver.recv_batch(buffers, packets);
+    REQUIRE(batch);
+    REQUIRE(batch->size() == 1);
+    CHECK((*batch)[0].timestamp >= result->timestamp);
+}
+#endif
+
+#ifdef __linux__
+TEST_CASE("socket send timestamps", "[socket]")
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{socket_protocol::ipv4, socket_flags::tx_timestamps};
+    socket receiver = socket{socket_protocol::ipv4, socket_flags::none};
+
+    REQUIRE(receiver.bind(socket_address::loopback(socket_protocol::ipv4)) == error_code::none);
+    auto receiver_address = receiver.address();
+    REQUIRE(receiver_address);
+
+    const auto before = std::chrono::system_clock::now() - std::chrono::milliseconds{10};
+
+    constexpr uint32_t         send_count = 3;
+    constexpr std::string_view message    = "hello there";
+    for(uint32_t i = 0; i < send_count; ++i)
+        REQUIRE(sender.send(*receiver_address, std::span{message}) == error_code::none);
+
+    // Every datagram is timestamped when scheduled and when sent, in order.
+    std::array<size_t, send_count> scheduled = {};
+    std::array<size_t, send_count> sent      = {};
+
+    std::chrono::system_clock::time_point previous = before;
+    while(auto timestamp = sender.poll_tx_timestamp())
+    {
+        REQUIRE(timestamp->id < send_count);
+        CHECK(timestamp->timestamp >= previous);
+        previous = timestamp->timestamp;
+
+        if(timestamp->stage == tx_timestamp_stage::scheduled)
+            ++scheduled[timestamp->id];
+        else
+            ++sent[timestamp->id];
+    }
+
+    CHECK(previous <= std::chrono::system_clock::now());
+    for(uint32_t i = 0; i < send_count; ++i)
+    {
+        CHECK(scheduled[i] == 1);
+        CHECK(sent[i] == 1);
+    }
+}
+#endif
+
+#ifdef __linux__
+TEST_CASE("socket drop counter", "[socket]")
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{socket_protocol::ipv4, socket_flags::none};
+    socket receiver = socket{socket_protocol::ipv4, socket_flags::drop_counter};
+
+    REQUIRE(receiver.bind(socket_address::loopback(socket_protocol::ipv4)) == error_code::none);
+    auto receiver_address = receiver.address();
+    REQUIRE(receiver_address);
+
+    auto initial_drops = receiver.dropped_packets();
+    REQUIRE(initial_drops);
+    CHECK(*initial_drops == 0);
+
+    // Overflow the receive buffer.
+    std::array<char, 8192> send_buffer = {};
+    for(size_t i = 0; i < 4096; ++i)
+        (void)sender.send(*receiver_address, std::span{send_buffer});
+
+    auto drops = receiver.dropped_packets();
+    REQUIRE(drops);
+    CHECK(*drops > 0);
+
+    // Packets report the drops which happened before they were received.
+    std::array<char, 8192> recv_buffer;
+
+    auto result = receiver.recv(std::span{recv_buffer});
+    REQUIRE(result);
+    CHECK(result->dropped <= *drops);
+    while(receiver.recv(std::span{recv_buffer}))
+        ;
+
+    REQUIRE(sender.send(*receiver_address, std::span{send_buffer}) == error_code::none);
+
+    auto last = receiver.recv_for(std::span{recv_buffer}, std::chrono::milliseconds{1000});
+    REQUIRE(last);
+    CHECK(last->dropped == *drops);
+}
+#endif
+
+TEST_CASE("socket buffer sizes", "[socket]")
+{
+    wadjet::socket_api socket_api;
+
+    socket buffered = socket{socket_protocol::ipv4, socket_flags::none};
+
+    // Buffers may be capped by system limits, but shouldn't end up smaller than requested ones
+    // well below those limits.
+    constexpr size_t size = 64 * 1024;
+    REQUIRE(buffered.set_recv_buffer_size(size) == error_code::none);
+    REQUIRE(buffered.set_send_buffer_size(size) == error_code::none);
+
+    auto recv_size = buffered.recv_buffer_size();
+    auto send_size = buffered.send_buffer_size();
+    REQUIRE(recv_size);
+    REQUIRE(send_size);
+    CHECK(*recv_size >= size);
+    CHECK(*send_size >= size);
+}
+
+#ifdef __linux__
+TEST_CASE("socket buffer occupancy", "[socket]")
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{socket_protocol::ipv4, socket_flags::none};
+    socket receiver = socket{socket_protocol::ipv4, socket_flags::none};
+
+    REQUIRE(receiver.bind(socket_address::loopback(socket_protocol::ipv4)) == error_code::none);
+    auto receiver_address = receiver.address();
+    REQUIRE(receiver_address);
+
+    auto empty = receiver.occupancy();
+    REQUIRE(empty);
+    CHECK(empty->recv_queued == 0);
+    CHECK(empty->recv_size > 0);
+
+    std::array<char, 1024> send_buffer = {};
+    REQUIRE(sender.send(*receiver_address, std::span{send_buffer}) == error_code::none);
+
+    // Queued sizes include the kernel overhead.
+    auto queued = receiver.occupancy();
+    REQUIRE(queued);
+    CHECK(queued->recv_queued >= send_buffer.size());
+
+    std::array<char, 1024> recv_buffer;
+    REQUIRE(receiver.recv(std::span{recv_buffer}));
+
+    auto drained = receiver.occupancy();
+    REQUIRE(drained);
+    CHECK(drained->recv_queued == 0);
+}
+#endif
+
+TEST_CASE("socket adaptive receive", "[socket]")
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{socket_protocol::ipv4, socket_flags::none};
+    socket receiver = socket{socket_protocol::ipv4, socket_flags::none};
+
+    REQUIRE(receiver.bind(socket_address::loopback(socket_protocol::ipv4)) == error_code::none);
+    auto receiver_address = receiver.address();
+    REQUIRE(receiver_address);
+
+    std::array<char, 64> recv_buffer;
+
+    spin_wait wait;
+    wait.max_spin = std::chrono::microseconds{100};
+    wait.spin     = std::chrono::microseconds{10};
+
+    // Nothing arrives while spinning, so the wait spins for less next time.
+    auto timeout =
+        receiver.recv_adaptive(std::span{recv_buffer}, wait, std::chrono::milliseconds{5});
+    REQUIRE(!timeout);
+    CHECK(timeout.error() == error_code::socket_would_block);
+    CHECK(wait.spin == std::chrono::microseconds{5});
+
+    // A waiting packet is received right away, so the wait spins for longer next time.
+    constexpr std::string_view message = "hello there";
+    REQUIRE(sender.send(*receiver_address, std::span{message}) == error_code::none);
+
+    auto result =
+        receiver.recv_adaptive(std::span{recv_buffer}, wait, std::chrono::milliseconds{1000});
+    REQUIRE(result);
+    CHECK(std::string_view{result->payload.data(), result->payload.size()} == message);
+    CHECK(wait.spin == std::chrono::microseconds{10});
+
+#ifdef __linux__
+    auto busy_poll_error = receiver.set_busy_poll(std::chrono::microseconds{50}, true, 8);
+    if(busy_poll_error != error_code::none)
+    {
+        WARN("busy polling unavailable, underlying error: " << busy_poll_error.underlying_code);
+        return;
+    }
+
+    REQUIRE(sender.send(*receiver_address, std::span{message}) == error_code::none);
+
+    auto polled =
+        receiver.recv_adaptive(std::span{recv_buffer}, wait, std::chrono::milliseconds{1000});
+    REQUIRE(polled);
+    CHECK(std::string_view{polled->payload.data(), polled->payload.size()} == message);
+#endif
+}
+
+TEST_CASE("socket truncated receive", "[socket]")
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{socket_protocol::ipv4, socket_flags::none};
+    socket receiver = socket{socket_protocol::ipv4, socket_flags::none};
+
+    REQUIRE(receiver.bind(socket_address::loopback(socket_protocol::ipv4)) == error_code::none);
+    auto receiver_address = receiver.address();
+    REQUIRE(receiver_address);
+
+    auto nothing = receiver.peek_size();
+    REQUIRE(!nothing);
+    CHECK(nothing.error() == error_code::socket_would_block);
+
+    constexpr std::string_view message = "hello there";
+    std::array<char, 100>      large   = {};
+    REQUIRE(sender.send(*receiver_address, std::span{large}) == error_code::none);
+    REQUIRE(sender.send(*receiver_address, std::span{message}) == error_code::none);
+
+    // Peeking doesn't consume the packet.
+    auto large_size = receiver.peek_size();
+    REQUIRE(large_size);
+    CHECK(*large_size == large.size());
+
+    std::array<char, 64> recv_buffer;
+
+    auto truncated = receiver.recv(std::span{recv_buffer});
+    REQUIRE(truncated);
+    CHECK(truncated->truncated);
+    CHECK(truncated->payload.size() == recv_buffer.size());
+#ifdef __linux__
+    CHECK(truncated->full_size == large.size());
+#endif
+
+    auto message_size = receiver.peek_size();
+    REQUIRE(message_size);
+    CHECK(*message_size == message.size());
+
+    auto whole = receiver.recv(std::span{recv_buffer});
+    REQUIRE(whole);
+    CHECK(!whole->truncated);
+    CHECK(whole->full_size == message.size());
+    CHECK(std::string_view{whole->payload.data(), whole->payload.size()} == message);
+}
+
+#ifdef __linux__
+TEST_CASE("socket packet info", "[socket]")
+{
+    wadjet::socket_api socket_api;
+
+    socket client = socket{socket_protocol::ipv4, socket_flags::none};
+    socket server = socket{socket_protocol::ipv4, socket_flags::packet_info};
+
+    REQUIRE(server.bind(socket_address::any(socket_protocol::ipv4)) == error_code::none);
+    auto server_address = server.address();
+    REQUIRE(server_address);
+
+    std::array<char, 64> recv_buffer;
+
+    // The whole 127.0.0.0/8 range belongs to the loopback interface, so the server is reachable
+    // through several local addresses.
+    for(const uint32_t local : {0x7f000001u, 0x7f000002u})
+    {
+        const socket_address local_address{local, server_address->port_host_order()};
+
+        constexpr std::string_view message = "hello there";
+        REQUIRE(client.send(local_address, std::span{message}) == error_code::none);
+
+        auto request = server.recv(std::span{recv_buffer});
+        REQUIRE(request);
+        CHECK(request->destination.ipv4() == local_address.ipv4());
+        CHECK(request->interface_index != 0);
+
+        // Replies come from the address the client talked to.
+        REQUIRE(server.send(request->address,
+                            request->payload,
+                            request->destination,
+                            request->interface_index)
+                == error_code::none);
+
+        auto reply = client.recv(std::span{recv_buffer});
+        REQUIRE(reply);
+        CHECK(reply->address.ipv4() == local_address.ipv4());
+        CHECK(reply->address.port_host_order() == server_address->port_host_order());
+    }
+}
+#endif
+
+#ifdef __linux__
+TEST_CASE("socket ecn", "[socket]")
+{
+    wadjet::socket_api socket_api;
+
+    // IPV4 packets reaching the dual-stack receiver carry the IPV4 traffic class.
+    for(const socket_protocol protocol : {socket_protocol::ipv4, socket_protocol::ipv6})
+    {
+        socket sender = socket{protocol, socket_flags::none};
+        socket receiver =
+            socket{socket_protocol::ipv6, socket_flags::dual_stack | socket_flags::ecn};
+
+        REQUIRE(receiver.bind(socket_address::any(socket_protocol::ipv6)) == error_code::none);
+        auto receiver_address = receiver.address();
+        REQUIRE(receiver_address);
+
+        const socket_address destination =
+            socket_address::loopback(protocol, receiver_address->port_host_order());
+
+        constexpr std::string_view message = "hello there";
+        std::array<char, 64>       recv_buffer;
+
+        for(const ecn_codepoint codepoint : {ecn_codepoint::ect0, ecn_codepoint::ce})
+        {
+            REQUIRE(sender.set_ecn(codepoint) == error_code::none);
+            REQUIRE(sender.send(destination, std::span{message}) == error_code::none);
+
+            auto result = receiver.recv(std::span{recv_buffer});
+            REQUIRE(result);
+            CHECK(result->ecn() == codepoint);
+            CHECK(result->traffic_class == static_cast<uint8_t>(codepoint));
+        }
+    }
+}
+#endif
+
+#ifdef __linux__
+TEST_CASE("socket paced send", "[socket]")
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{socket_protocol::ipv4, socket_flags::txtime};
+    socket receiver = socket{socket_protocol::ipv4, socket_flags::none};
+
+    REQUIRE(receiver.bind(socket_address::loopback(socket_protocol::ipv4)) == error_code::none);
+    auto receiver_address = receiver.address();
+    REQUIRE(receiver_address);
+
+    // Loopback has no queueing discipline which enforces pacing, so packets arrive right away.
+    REQUIRE(sender.set_pacing_rate(1024 * 1024) == error_code::none);
+
+    constexpr std::string_view message   = "hello there";
+    const auto                 departure = std::chrono::steady_clock::now();
+
+    REQUIRE(sender.send_at(*receiver_address, std::span{message}, departure) == error_code::none);
+
+    std::array<outgoing_packet, 4> packets;
+    for(size_t i = 0; i < packets.size(); ++i)
+    {
+        packets[i].address   = *receiver_address;
+        packets[i].payload   = std::span{message};
+        packets[i].departure = departure + i * std::chrono::microseconds{100};
+    }
+
+    auto sent = sender.send_batch(std::span{packets});
+    REQUIRE(sent);
+    CHECK(*sent == packets.size());
+
+    std::array<char, 64> recv_buffer;
+    for(size_t i = 0; i < packets.size() + 1; ++i)
+    {
+        auto result = receiver.recv_for(std::span{recv_buffer}, std::chrono::milliseconds{1000});
+        REQUIRE(result);
+        CHECK(std::string_view{result->payload.data(), result->payload.size()} == message);
+    }
+
+    // Departure times require the socket to be created with socket_flags::txtime.
+    socket unpaced = socket{socket_protocol::ipv4, socket_flags::none};
+    CHECK(unpaced.send_at(*receiver_address, std::span{message}, departure) != error_code::none);
+}
+#endif
+
+TEST_CASE("socket gathered send", "[socket]")
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{socket_protocol::ipv4, socket_flags::none};
+    socket receiver = socket{socket_protocol::ipv4, socket_flags::none};
+
+    REQUIRE(receiver.bind(socket_address::loopback(socket_protocol::ipv4)) == error_code::none);
+    auto receiver_address = receiver.address();
+    REQUIRE(receiver_address);
+
+    constexpr std::string_view header  = "header:";
+    constexpr std::string_view body    = "hello there";
+    constexpr std::string_view trailer = ":trailer";
+
+    const std::array<std::span<const char>, 3> buffers{
+        std::span{header}, std::span{body}, std::span{trailer}};
+    REQUIRE(sender.send(*receiver_address, std::span{buffers}) == error_code::none);
+
+    std::array<char, 64> recv_buffer;
+
+    auto result = receiver.recv_for(std::span{recv_buffer}, std::chrono::milliseconds{1000});
+    REQUIRE(result);
+    CHECK(std::string_view{result->payload.data(), result->payload.size()}
+          == "header:hello there:trailer");
+
+    // Datagrams can't be gathered from more than max_buffer_count buffers.
+    std::array<std::span<const char>, socket::max_buffer_count + 1> too_many;
+    too_many.fill(std::span{body});
+    CHECK(sender.send(*receiver_address, std::span{too_many}) != error_code::none);
+}
+
+TEST_CASE("socket scattered recv", "[socket]")
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{socket_protocol::ipv4, socket_flags::none};
+    socket receiver = socket{socket_protocol::ipv4, socket_flags::none};
+
+    REQUIRE(receiver.bind(socket_address::loopback(socket_protocol::ipv4)) == error_code::none);
+    auto receiver_address = receiver.address();
+    REQUIRE(receiver_address);
+
+    constexpr std::string_view message = "header:hello there";
+
+    std::array<char, 7>  header;
+    std::array<char, 64> body;
+
+    const std::array<std::span<char>, 2> buffers{std::span{header}, std::span{body}};
+
+    // The header fills the first buffer, and the rest of the datagram lands in the second one.
+    REQUIRE(sender.send(*receiver_address, std::span{message}) == error_code::none);
+
+    auto result = receiver.recv(std::span{buffers});
+    REQUIRE(result);
+    CHECK(result->address.port_host_order() != 0);
+    CHECK(!result->truncated);
+    CHECK(result->full_size == message.size());
+    CHECK(std::string_view{result->payload.data(), result->payload.size()} == "header:");
+    CHECK(std::string_view{body.data(), result->full_size - header.size()} == "hello there");
+
+    // Datagrams which don't fit into all of the buffers combined are cut short.
+    const std::array<std::span<char>, 2> small_buffers{std::span{header},
+                                                       std::span{body}.first(4)};
+    REQUIRE(sender.send(*receiver_address, std::span{message}) == error_code::none);
+
+    auto truncated = receiver.recv(std::span{small_buffers});
+    REQUIRE(truncated);
+    CHECK(truncated->truncated);
+    CHECK(truncated->payload.size() == header.size());
+    CHECK(std::min(truncated->full_size, header.size() + 4) - header.size() == 4);
+    CHECK(std::string_view{body.data(), 4} == "hell");
+}
+
+#ifdef __linux__
+TEST_CASE("socket endpoint recv metadata", "[socket]")
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{socket_protocol::ipv4, socket_flags::none};
+    socket receiver = socket{socket_protocol::ipv4, socket_flags::rx_timestamps};
+
+    REQUIRE(receiver.bind(socket_address::loopback(socket_protocol::ipv4)) == error_code::none);
+    auto receiver_address = receiver.address();
+    REQUIRE(receiver_address);
+
+    constexpr std::string_view message = "hello there";
+    REQUIRE(sender.send(*receiver_address, std::span{message}) == error_code::none);
+
+    // Receiving into an endpoint still reports truncation and control messages.
+    std::array<char, 5> recv_buffer;
+    socket_endpoint     source;
+
+    auto result = receiver.recv(std::span{recv_buffer}, source);
+    REQUIRE(result);
+    CHECK(result->truncated);
+    CHECK(result->full_size == message.size());
+    CHECK(result->timestamp != std::chrono::system_clock::time_point{});
+
+    auto sender_address = sender.address();
+    REQUIRE(sender_address);
+    CHECK(source.address().port_host_order() == sender_address->port_host_order());
+}
+#endif
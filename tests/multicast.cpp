@@ -0,0 +1,147 @@
+#ifdef __linux__
+
+#include "catch_amalgamated.hpp"
+
+#include <wadjet/socket.hpp>
+
+// Declares ::socket, so the wrapper has to be referred to as wadjet::socket here.
+#include <net/if.h>
+
+#include <array>
+#include <string_view>
+
+using namespace wadjet;
+
+namespace {
+
+// Multicast is tested over the loopback interface, so that no network is required.
+uint32_t loopback_interface()
+{
+    return ::if_nametoindex("lo");
+}
+
+} // namespace
+
+TEST_CASE("socket multicast fan-out", "[multicast]")
+{
+    wadjet::socket_api socket_api;
+
+    const uint32_t interface_index = loopback_interface();
+    REQUIRE(interface_index != 0);
+
+    // Both subscribers share the group's port, and each of them receives its own copy.
+    wadjet::socket first  = wadjet::socket{socket_protocol::ipv4, socket_flags::reuse_port};
+    wadjet::socket second = wadjet::socket{socket_protocol::ipv4, socket_flags::reuse_port};
+
+    REQUIRE(first.bind(socket_address::any(socket_protocol::ipv4)) == error_code::none);
+    auto first_address = first.address();
+    REQUIRE(first_address);
+
+    const uint16_t port = first_address->port_host_order();
+    REQUIRE(second.bind(socket_address::any(socket_protocol::ipv4, port)) == error_code::none);
+
+    const socket_address group{socket_protocol::ipv4, "239.255.0.1", port};
+    REQUIRE(first.join_group(group, interface_index) == error_code::none);
+    REQUIRE(second.join_group(group, interface_index) == error_code::none);
+
+    wadjet::socket publisher = wadjet::socket{socket_protocol::ipv4, socket_flags::none};
+    REQUIRE(publisher.set_multicast_interface(interface_index) == error_code::none);
+    REQUIRE(publisher.set_multicast_loop(true) == error_code::none);
+    REQUIRE(publisher.set_multicast_ttl(1) == error_code::none);
+
+    constexpr std::string_view message = "hello there";
+    REQUIRE(publisher.send(group, std::span{message}) == error_code::none);
+
+    std::array<char, 64> recv_buffer;
+    for(const wadjet::socket* subscriber : {&first, &second})
+    {
+        auto result = subscriber->recv_for(std::span{recv_buffer}, std::chrono::milliseconds{1000});
+        REQUIRE(result);
+        CHECK(std::string_view{result->payload.data(), result->payload.size()} == message);
+    }
+
+    // Linux keeps delivering the group to every socket bound to the port as long as any of them is
+    // a member, so both have to leave.
+    REQUIRE(first.leave_group(group, interface_index) == error_code::none);
+    REQUIRE(second.leave_group(group, interface_index) == error_code::none);
+    REQUIRE(publisher.send(group, std::span{message}) == error_code::none);
+
+    CHECK(!first.recv(std::span{recv_buffer}));
+    CHECK(!second.recv(std::span{recv_buffer}));
+}
+
+TEST_CASE("socket dual-stack multicast to an ipv4 group", "[multicast]")
+{
+    wadjet::socket_api socket_api;
+
+    const uint32_t interface_index = loopback_interface();
+    REQUIRE(interface_index != 0);
+
+    wadjet::socket subscriber = wadjet::socket{socket_protocol::ipv4, socket_flags::none};
+    REQUIRE(subscriber.bind(socket_address::any(socket_protocol::ipv4)) == error_code::none);
+    auto subscriber_address = subscriber.address();
+    REQUIRE(subscriber_address);
+
+    const socket_address group{
+        socket_protocol::ipv4, "239.255.0.2", subscriber_address->port_host_order()};
+    REQUIRE(subscriber.join_group(group, interface_index) == error_code::none);
+
+    // The interface has to carry over to the ipv4 side of the socket for the group to be reached.
+    wadjet::socket publisher = wadjet::socket{socket_protocol::ipv6, socket_flags::dual_stack};
+    REQUIRE(publisher.set_multicast_interface(interface_index) == error_code::none);
+    REQUIRE(publisher.set_multicast_loop(true) == error_code::none);
+
+    constexpr std::string_view message = "hello there";
+    REQUIRE(publisher.send(group, std::span{message}) == error_code::none);
+
+    std::array<char, 64> recv_buffer;
+
+    auto result = subscriber.recv_for(std::span{recv_buffer}, std::chrono::milliseconds{1000});
+    REQUIRE(result);
+    CHECK(std::string_view{result->payload.data(), result->payload.size()} == message);
+
+    REQUIRE(subscriber.leave_group(group, interface_index) == error_code::none);
+}
+
+TEST_CASE("socket source-specific multicast", "[multicast]")
+{
+    wadjet::socket_api socket_api;
+
+    const uint32_t interface_index = loopback_interface();
+    REQUIRE(interface_index != 0);
+
+    wadjet::socket subscriber = wadjet::socket{socket_protocol::ipv4, socket_flags::none};
+    REQUIRE(subscriber.bind(socket_address::any(socket_protocol::ipv4)) == error_code::none);
+    auto subscriber_address = subscriber.address();
+    REQUIRE(subscriber_address);
+
+    const uint16_t       port = subscriber_address->port_host_order();
+    const socket_address group{socket_protocol::ipv4, "232.1.1.1", port};
+    const socket_address source{socket_protocol::ipv4, "127.0.0.1"};
+    REQUIRE(subscriber.join_source_group(group, source, interface_index) == error_code::none);
+
+    // Only the publisher at the subscribed source gets through.
+    wadjet::socket publisher = wadjet::socket{socket_protocol::ipv4, socket_flags::none};
+    wadjet::socket stranger  = wadjet::socket{socket_protocol::ipv4, socket_flags::none};
+    REQUIRE(publisher.bind(socket_address{socket_protocol::ipv4, "127.0.0.1"}) == error_code::none);
+    REQUIRE(stranger.bind(socket_address{socket_protocol::ipv4, "127.0.0.2"}) == error_code::none);
+
+    for(const wadjet::socket* sender : {&stranger, &publisher})
+        REQUIRE(sender->set_multicast_interface(interface_index) == error_code::none);
+
+    constexpr std::string_view noise   = "noise";
+    constexpr std::string_view message = "hello there";
+    REQUIRE(stranger.send(group, std::span{noise}) == error_code::none);
+    REQUIRE(publisher.send(group, std::span{message}) == error_code::none);
+
+    std::array<char, 64> recv_buffer;
+
+    auto result = subscriber.recv_for(std::span{recv_buffer}, std::chrono::milliseconds{1000});
+    REQUIRE(result);
+    CHECK(std::string_view{result->payload.data(), result->payload.size()} == message);
+    CHECK(!subscriber.recv(std::span{recv_buffer}));
+
+    REQUIRE(subscriber.leave_source_group(group, source, interface_index) == error_code::none);
+}
+
+#endif
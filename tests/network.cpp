@@ -66,6 +66,23 @@ TEST_CASE("socket address to string", "[socket_address]")
     }
 }
 
+TEST_CASE("socket address protocol", "[socket_address]")
+{
+    CHECK(socket_address{socket_protocol::ipv4, "127.0.0.1"}.protocol() == socket_protocol::ipv4);
+    CHECK(socket_address{socket_protocol::ipv6, "::1"}.protocol() == socket_protocol::ipv6);
+    CHECK(socket_address::loopback(socket_protocol::ipv6).protocol() == socket_protocol::ipv6);
+}
+
+TEST_CASE("socket address multicast", "[socket_address]")
+{
+    CHECK(socket_address{socket_protocol::ipv4, "239.255.0.1"}.is_multicast());
+    CHECK(socket_address{socket_protocol::ipv4, "224.0.0.1"}.is_multicast());
+    CHECK(!socket_address{socket_protocol::ipv4, "127.0.0.1"}.is_multicast());
+    CHECK(socket_address{socket_protocol::ipv6, "ff02::1"}.is_multicast());
+    CHECK(socket_address{socket_protocol::ipv6, "::ffff:239.255.0.1"}.is_multicast());
+    CHECK(!socket_address{socket_protocol::ipv6, "::1"}.is_multicast());
+}
+
 TEST_CASE("socket address copy", "[socket_address]")
 {
     std::array<char, 1024> buffer;
@@ -0,0 +1,82 @@
+#ifdef __linux__
+
+#include "catch_amalgamated.hpp"
+
+#include <wadjet/poller.hpp>
+
+#include <array>
+#include <string_view>
+
+using namespace wadjet;
+
+TEST_CASE("poller timeout", "[poller]")
+{
+    wadjet::socket_api socket_api;
+
+    socket receiver = socket{socket_protocol::ipv4, socket_flags::none};
+    REQUIRE(receiver.bind(socket_address::any(socket_protocol::ipv4)) == error_code::none);
+
+    poller poller;
+
+    bool dispatched = false;
+    REQUIRE(poller.add(receiver,
+                       poll_events::readable,
+                       poll_mode::level_triggered,
+                       [&](const socket&, poll_events) { dispatched = true; })
+            == error_code::none);
+
+    auto result = poller.wait(std::chrono::milliseconds{10});
+    REQUIRE(result);
+    CHECK(*result == 0);
+    CHECK(!dispatched);
+}
+
+TEST_CASE("poller dispatch", "[poller]")
+{
+    wadjet::socket_api socket_api;
+
+    socket sender   = socket{socket_protocol::ipv4, socket_flags::none};
+    socket receiver = socket{socket_protocol::ipv4, socket_flags::none};
+
+    REQUIRE(receiver.bind(socket_address::any(socket_protocol::ipv4)) == error_code::none);
+    auto receiver_address = receiver.address();
+    REQUIRE(receiver_address);
+
+    poller poller;
+
+    size_t received = 0;
+    REQUIRE(poller.add(receiver,
+                       poll_events::readable,
+                       poll_mode::edge_triggered,
+                       [&](const socket& socket, poll_events events) {
+                           CHECK(&socket == &receiver);
+                           CHECK(detail::enum_get(events, poll_events::readable));
+
+                           // Edge-triggered sockets must be drained.
+                           std::array<char, 64> buffer;
+                           while(socket.recv(std::span{buffer}))
+                               ++received;
+                       })
+            == error_code::none);
+
+    constexpr std::string_view message = "hello there";
+    auto address =
+        socket_address::loopback(socket_protocol::ipv4, receiver_address->port_host_order());
+    REQUIRE(sender.send(address, std::span{message}) == error_code::none);
+    REQUIRE(sender.send(address, std::span{message}) == error_code::none);
+
+    auto result = poller.wait(std::chrono::milliseconds{1000});
+    REQUIRE(result);
+    CHECK(*result == 1);
+    CHECK(received == 2);
+
+    // Once removed, the socket is no longer dispatched.
+    REQUIRE(poller.remove(receiver) == error_code::none);
+    REQUIRE(sender.send(address, std::span{message}) == error_code::none);
+
+    auto removed_result = poller.wait(std::chrono::milliseconds{10});
+    REQUIRE(removed_result);
+    CHECK(*removed_result == 0);
+}
+
+#endif
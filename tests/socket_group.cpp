@@ -0,0 +1,158 @@
+#ifndef WIN32
+
+#include "catch_amalgamated.hpp"
+
+#include <wadjet/socket_group.hpp>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include <array>
+#include <string_view>
+#include <vector>
+
+using namespace wadjet;
+
+TEST_CASE("socket group distributes flows", "[socket_group]")
+{
+    wadjet::socket_api socket_api;
+
+    constexpr size_t group_size = 4;
+
+    socket_group group{socket_protocol::ipv4,
+                       socket_flags::none,
+                       socket_address::any(socket_protocol::ipv4),
+                       group_size};
+    REQUIRE(group.size() == group_size);
+    REQUIRE(group.address().port_host_order() != 0);
+
+    // Every member shares the port picked by the first one.
+    for(size_t i = 0; i < group.size(); ++i)
+    {
+        CHECK(group[i].index() == i);
+
+        auto address = group[i].socket().address();
+        REQUIRE(address);
+        CHECK(address->port_host_order() == group.address().port_host_order());
+    }
+
+    // Each sender is a separate flow, which the kernel hashes to one of the members.
+    constexpr size_t           sender_count = 32;
+    constexpr std::string_view message      = "hello there";
+    auto address =
+        socket_address::loopback(socket_protocol::ipv4, group.address().port_host_order());
+
+    std::vector<socket> senders;
+    for(size_t i = 0; i < sender_count; ++i)
+    {
+        senders.emplace_back(socket_protocol::ipv4, socket_flags::none);
+        REQUIRE(senders.back().send(address, std::span{message}) == error_code::none);
+    }
+
+    size_t received = 0;
+    for(size_t i = 0; i < group.size(); ++i)
+    {
+        std::array<char, 64> buffer;
+        while(auto packet = group[i].recv(std::span{buffer}))
+        {
+            CHECK(std::string_view{packet->payload.data(), packet->payload.size()} == message);
+            ++received;
+        }
+
+        const socket_group_stats stats = group[i].stats();
+        CHECK(stats.bytes_received == stats.packets_received * message.size());
+    }
+
+    CHECK(received == sender_count);
+
+    const socket_group_stats stats = group.stats();
+    CHECK(stats.packets_received == sender_count);
+    CHECK(stats.bytes_received == sender_count * message.size());
+    CHECK(stats.packets_sent == 0);
+}
+
+TEST_CASE("socket group member accounts timed receives", "[socket_group]")
+{
+    wadjet::socket_api socket_api;
+
+    socket_group group{socket_protocol::ipv4,
+                       socket_flags::none,
+                       socket_address::any(socket_protocol::ipv4),
+                       1};
+
+    constexpr std::string_view message = "hello there";
+    auto address =
+        socket_address::loopback(socket_protocol::ipv4, group.address().port_host_order());
+
+    socket sender = socket{socket_protocol::ipv4, socket_flags::none};
+    REQUIRE(sender.send(address, std::span{message}) == error_code::none);
+
+    std::array<char, 64> buffer;
+
+    auto packet = group[0].recv_for(std::span{buffer}, std::chrono::milliseconds{1000});
+    REQUIRE(packet);
+    CHECK(std::string_view{packet->payload.data(), packet->payload.size()} == message);
+
+    // Timing out isn't accounted.
+    CHECK(!group[0].recv_for(std::span{buffer}, std::chrono::milliseconds{10}));
+
+    const socket_group_stats stats = group[0].stats();
+    CHECK(stats.packets_received == 1);
+    CHECK(stats.bytes_received == message.size());
+}
+
+#ifdef __linux__
+TEST_CASE("socket group steers by cpu", "[socket_group]")
+{
+    wadjet::socket_api socket_api;
+
+    socket_group group{socket_protocol::ipv4,
+                       socket_flags::none,
+                       socket_address::any(socket_protocol::ipv4),
+                       2};
+    REQUIRE(group.steer_by_cpu() == error_code::none);
+
+    // Restore the original affinity of the test thread afterwards.
+    ::cpu_set_t original_cpus;
+    REQUIRE(::sched_getaffinity(0, sizeof(original_cpus), &original_cpus) == 0);
+
+    int cpu = 0;
+    while(!CPU_ISSET(cpu, &original_cpus))
+        ++cpu;
+
+    auto index = group.pin_current_thread(cpu);
+    REQUIRE(index);
+    CHECK(*index == static_cast<size_t>(cpu) % group.size());
+
+    // Loopback packets are processed on the sending CPU, so they all reach the same member.
+    constexpr size_t           sender_count = 8;
+    constexpr std::string_view message      = "hello there";
+    auto address =
+        socket_address::loopback(socket_protocol::ipv4, group.address().port_host_order());
+
+    std::vector<socket> senders;
+    for(size_t i = 0; i < sender_count; ++i)
+    {
+        senders.emplace_back(socket_protocol::ipv4, socket_flags::none);
+        REQUIRE(senders.back().send(address, std::span{message}) == error_code::none);
+    }
+
+    std::array<char, 64> buffer;
+    for(size_t i = 0; i < group.size(); ++i)
+    {
+        while(group[i].recv(std::span{buffer}))
+            ;
+    }
+
+    CHECK(group[*index].stats().packets_received == sender_count);
+
+    auto incoming_cpu = group[*index].socket().incoming_cpu();
+    REQUIRE(incoming_cpu);
+    CHECK(*incoming_cpu == cpu);
+
+    REQUIRE(::sched_setaffinity(0, sizeof(original_cpus), &original_cpus) == 0);
+}
+#endif
+
+#endif